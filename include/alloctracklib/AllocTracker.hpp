@@ -0,0 +1,45 @@
+#ifndef ALLOCTRACKLIB_ALLOCTRACKER_HPP
+#define ALLOCTRACKLIB_ALLOCTRACKER_HPP
+
+#include <cstddef>
+
+namespace alloctracklib
+{
+
+/* Counts kept by the replacement operator new/delete linked in with alloctracklib
+   Counts are per thread. Byte counts are the usable size of each block as reported by the allocator, which is what
+   the allocation really costs rather than what was asked for. */
+struct AllocStats
+{
+    std::size_t allocations_;               // Calls to any form of operator new
+    std::size_t deallocations_;             // Calls to any form of operator delete with a non null pointer
+    std::size_t bytesAllocated_;            // Total bytes handed out
+    long long liveBytes_;                   // Bytes currently allocated and not yet freed
+    long long peakLiveBytes_;               // High water mark of liveBytes_
+};
+
+// Totals for the calling thread since it started
+AllocStats threadStats();
+
+/* Measures the allocations made by the calling thread during its lifetime
+   Peak live bytes are relative to the live bytes when the scope was opened. Scopes may nest. */
+class AllocScope
+{
+public:
+    AllocScope();
+    ~AllocScope();
+
+    AllocScope(const AllocScope &) = delete;
+    AllocScope & operator=(const AllocScope &) = delete;
+
+    // Counts since construction
+    AllocStats stats() const;
+
+private:
+    AllocStats m_start;
+    long long m_outerPeak;                  // Peak of any enclosing scope, restored on destruction
+};
+
+} // end namespace alloctracklib
+
+#endif // ALLOCTRACKLIB_ALLOCTRACKER_HPP
@@ -0,0 +1,51 @@
+#ifndef ALLOCTRACKLIB_LAYOUTREPORT_HPP
+#define ALLOCTRACKLIB_LAYOUTREPORT_HPP
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace alloctracklib
+{
+
+struct FieldLayout
+{
+    std::string name_;                      // Name of the data member, as written in the source
+    std::size_t offset_;                    // Offset from the start of the complete object
+    std::size_t size_;                      // sizeof the data member
+};
+
+struct TypeLayout
+{
+    std::string name_;                      // Name of the type
+    std::size_t size_;                      // sizeof the type
+    std::size_t alignment_;                 // alignof the type
+    std::vector<FieldLayout> fields_;       // Data members, including those of base classes
+
+    // Bytes not taken by any listed field: padding, vtable and virtual base pointers
+    std::size_t unaccountedBytes() const;
+};
+
+/* Describe a data member of a sample object
+   Offsets are measured on a live object instead of with offsetof, which is not supported for types with virtual
+   bases. */
+template <class T, class M>
+FieldLayout fieldLayout(const char * name, const T & object, const M & member)
+{
+    auto offset = reinterpret_cast<const char *>(&member) - reinterpret_cast<const char *>(&object);
+    return FieldLayout{ name, static_cast<std::size_t>(offset), sizeof(M) };
+}
+
+template <class T>
+TypeLayout typeLayout(const char * name, std::vector<FieldLayout> fields)
+{
+    return TypeLayout{ name, sizeof(T), alignof(T), std::move(fields) };
+}
+
+// Print each field with its offset and size, and the gaps between them
+void printLayout(const TypeLayout & layout, std::ostream & out);
+
+} // end namespace alloctracklib
+
+#endif // ALLOCTRACKLIB_LAYOUTREPORT_HPP
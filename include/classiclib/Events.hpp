@@ -1,8 +1,17 @@
 #ifndef CLASSICLIB_EVENTS_HPP
 #define CLASSICLIB_EVENTS_HPP
 
+#include "commonlib/EventKind.hpp"
+#include "commonlib/FieldDescriptor.hpp"
+#include "commonlib/Json.hpp"
+#include "commonlib/LogParser.hpp"
+#include "commonlib/Sink.hpp"
+
 #include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
 #include <variant>
 
@@ -72,7 +81,207 @@ struct AuthLogoutEvent : public AuthEventBase
 };
 
 
-/* Dispatcher for top level event into subtype handlers */
+/* Handler for auth events, writing into any sink */
+template <commonlib::EventSink Sink>
+void handleAuthEvent(const AuthEventBase * authEvent, Sink & sink)
+{
+    if (!authEvent)
+    {
+        throw std::invalid_argument("Auth event is not valid");
+    }
+
+    sink.append("User is ");
+    sink.append(authEvent->userId_);
+    sink.append("\n");
+
+    switch(authEvent->type_)
+    {
+        case EventType::AUTH_LOGIN:
+        {
+            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
+               then we could static_cast, but if they do mislabel then we run the risk of UB
+            auto loginEvent = static_cast<const AuthLoginEvent *>(authEvent);
+            */
+            auto loginEvent = dynamic_cast<const AuthLoginEvent *>(authEvent);
+            if(!loginEvent) 
+            { 
+                throw std::runtime_error("Cast to auth login event type failed");
+            }
+
+            sink.append("Some specific data for auth login: ");
+            commonlib::appendInteger(sink, loginEvent->someSpecificData_);
+            sink.append("\n");
+            break;
+        }
+        case EventType::AUTH_LOGOUT:
+        {
+            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
+               then we could static_cast, but if they do mislabel then we run the risk of UB
+            auto logoutEvent = static_cast<const AuthLogoutEvent *>(authEvent);
+            */
+            auto logoutEvent = dynamic_cast<const AuthLogoutEvent *>(authEvent);
+            if(!logoutEvent) 
+            { 
+                throw std::runtime_error("Cast to auth logout event type failed");
+            }
+
+            sink.append("Some specific data for auth logout: ");
+            commonlib::appendInteger(sink, logoutEvent->someSpecificData_);
+            sink.append("\n");
+            break;
+        }
+        default:
+        {
+            throw std::invalid_argument("Unknown auth event type encountered");
+            break;
+        }
+    }
+}
+
+/* Handler for session events, writing into any sink */
+template <commonlib::EventSink Sink>
+void handleSessionEvent(const SessionEventBase * sessionEvent, Sink & sink)
+{
+    if (!sessionEvent)
+    {
+        throw std::invalid_argument("Session event is not valid");
+    }
+
+    sink.append("Session id is ");
+    sink.append(sessionEvent->sessionId_);
+    sink.append("\n");
+
+    switch(sessionEvent->type_)
+    {
+        case EventType::SESSION_START:
+        {
+            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
+               then we could static_cast, but if they do mislabel then we run the risk of UB
+            auto startEvent = static_cast<const SessionStartEvent *>(sessionEvent);
+            */
+            auto startEvent = dynamic_cast<const SessionStartEvent *>(sessionEvent);
+            if(!startEvent)
+            { 
+                throw std::runtime_error("Cast to session start event type failed");
+            }
+
+            sink.append("Some specific data for session start: ");
+            commonlib::appendInteger(sink, startEvent->someSpecificData_);
+            sink.append("\n");
+            break;
+        }
+        case EventType::SESSION_END:
+        {
+            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
+               then we could static_cast, but if they do mislabel then we run the risk of UB
+            auto endEvent = static_cast<const SessionEndEvent *>(sessionEvent);
+            */
+            auto endEvent = dynamic_cast<const SessionEndEvent *>(sessionEvent);
+            if(!endEvent)
+            { 
+                throw std::runtime_error("Cast to session end event type failed");
+            }
+
+            sink.append("Some specific data for session end: ");
+            commonlib::appendInteger(sink, endEvent->someSpecificData_);
+            sink.append("\n");
+            break;
+        }
+        default:
+        {
+            throw std::runtime_error("Unknown session event type encountered");
+            break;
+        }
+    }
+}
+
+/* Dispatcher for top level event into subtype handlers, writing into any sink */
+template <commonlib::EventSink Sink>
+void handleEvent(const EventBase * event, Sink & sink)
+{
+    if(!event)
+    {
+        throw std::invalid_argument("Event is not valid");
+    }
+
+    sink.append("PID is ");
+    commonlib::appendInteger(sink, event->pid_);
+    sink.append("\nTimestamp is ");
+    commonlib::appendTimestamp(sink, event->timestamp_);
+    sink.append("\n");
+
+    switch(event->type_)
+    {
+        case EventType::SESSION_START:
+        case EventType::SESSION_END:
+        {
+            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
+               then we could static_cast, but if they do mislabel then we run the risk of UB
+            auto sessionEvent = static_cast<const SessionEventBase *>(event);
+            */
+            auto sessionEvent = dynamic_cast<const SessionEventBase *>(event);
+            if(!sessionEvent) 
+            { 
+                throw std::runtime_error("Cast to session event type failed"); 
+            }
+
+            handleSessionEvent(sessionEvent, sink);
+            break;
+        }
+        case EventType::AUTH_LOGIN:
+        case EventType::AUTH_LOGOUT:
+        {
+            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
+               then we could static_cast, but if they do mislabel then we run the risk of UB
+            auto authEvent = static_cast<const AuthEventBase *>(event);
+            */
+            auto authEvent = dynamic_cast<const AuthEventBase *>(event);
+            if(!authEvent)
+            { 
+                throw std::runtime_error("Cast to session event type failed"); 
+            }
+
+            handleAuthEvent(authEvent, sink);
+            break;
+        }
+        default:
+            // Handle unknown event type
+            throw std::invalid_argument("Unknown event type encountered");
+            break;
+    }
+}
+
+/* Library neutral type of an event */
+commonlib::EventKind eventKind(const EventBase * event);
+
+/* Fields every event has, for code that does not care about the type */
+inline short eventPid(const EventBase * event) { return event->pid_; }
+inline std::chrono::system_clock::time_point eventTimestamp(const EventBase * event) { return event->timestamp_; }
+
+/* Rebuild an event read back from handler output by commonlib::LogParser */
+std::unique_ptr<EventBase> makeEvent(const commonlib::ParsedEvent & parsed);
+
+/* The concrete type's field descriptors and the event itself
+   Pass to commonlib::formatDescribed or commonlib::encodeDescribed */
+commonlib::DescribedEvent describe(const EventBase * event);
+
+/* Write an event as one line of JSON, the JSON lines counterpart of handleEvent */
+template <commonlib::EventSink Sink>
+void handleEventJson(const EventBase * event, Sink & sink)
+{
+    commonlib::formatJson(sink, describe(event));
+}
+
+/* Hash of the session or user id, the same for every event of one session or user
+   Used to sample whole sessions rather than single events */
+std::uint64_t samplingKey(const EventBase * event);
+
+/* Hash of the type, pid, timestamp, id and specific data of an event
+   Equal for every delivery of the same event, so it can be used to drop retried duplicates */
+std::uint64_t fingerprint(const EventBase * event);
+
+/* Dispatcher for top level event into subtype handlers
+   Thin wrapper over the sink version. The stream is flushed once per event */
 void handleEvent(const EventBase * event, std::ostream & out);
 
 } // end namespace eventlib
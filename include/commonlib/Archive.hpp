@@ -0,0 +1,136 @@
+#ifndef COMMONLIB_ARCHIVE_HPP
+#define COMMONLIB_ARCHIVE_HPP
+
+#include "commonlib/EventKind.hpp"
+#include "commonlib/FieldDescriptor.hpp"
+#include "commonlib/LogParser.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace commonlib
+{
+
+/* Column compressed blocks of events for long term storage
+   Events are grouped into blocks and each block stores every field as a column. Little endian throughout:
+
+     header     "EVB1", uint32 event count, uint32 block bytes (header included),
+                int64 min and max timestamp in nanoseconds, so a reader can skip the block by time range
+     kind, pid  dictionary: uint32 entry count, uint16 entries, then a packed index per event
+     timestamp  int64 first, int64 first delta, then the delta of delta of each further event, zigzag and packed
+     id         dictionary: uint32 entry count, entries as varint length and bytes, then a packed index per event
+     data       int32 block minimum, then each value less the minimum, packed
+
+   A packed column is one byte of bit width followed by the values at that width, least significant bit first, and
+   8 bytes of zero padding so the decoder can always load a whole word. A column whose values are all equal packs to
+   width 0 and takes no bytes beyond the padding. Sample weights are not stored. */
+class ArchiveWriter
+{
+public:
+    // Most events a block may hold, so a reader can reject a corrupt count before allocating for it
+    static constexpr std::size_t MaxBlockEvents = std::size_t(1) << 20;
+
+    // Most bytes of distinct ids a block may hold, which keeps it well inside the 4 GiB its header can describe
+    static constexpr std::size_t MaxBlockIdBytes = std::size_t(1) << 30;
+
+    /* A block is encoded once it has blockEvents events, or earlier if another distinct id would take its ids over
+       blockIdBytes. Throws std::invalid_argument if either is 0 or over its maximum */
+    explicit ArchiveWriter(std::size_t blockEvents = 4096, std::size_t blockIdBytes = MaxBlockIdBytes);
+
+    /* Add an event from any library's describe(). Its fields are taken by type: INT16 is the pid, TIMESTAMP the
+       timestamp, STRING the id and INT32 the specific data. Throws std::length_error if the id alone is over
+       blockIdBytes */
+    void append(const DescribedEvent & event);
+
+    // Add an event read back by LogParser, to convert text logs
+    void append(const ParsedEvent & event);
+
+    // Encode the events not yet in a block as a last, short block
+    void finish();
+
+    // Encoded blocks so far. Write them out and clear() to keep memory bounded
+    const std::string & data() const { return m_output; }
+    void clear() { m_output.clear(); }
+
+    std::size_t events() const { return m_events; }
+
+private:
+    // Lets the id dictionary be searched with a string_view, without making a string
+    struct IdHash
+    {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view id) const { return std::hash<std::string_view>{}(id); }
+    };
+
+    void add(EventKind kind, short pid, std::chrono::system_clock::time_point timestamp, std::string_view id, int someSpecificData);
+    void encodeBlock();
+
+    std::size_t m_blockEvents;
+    std::size_t m_blockIdBytes;
+    std::size_t m_events;                                       // Appended in total
+    std::string m_output;
+
+    // Columns of the block being filled
+    std::vector<std::uint16_t> m_kinds;
+    std::vector<std::uint16_t> m_pids;
+    std::vector<std::int64_t> m_timestamps;
+    std::vector<std::uint32_t> m_idIndexes;
+    std::vector<std::string_view> m_idEntries;                  // Keys of m_idDictionary in index order
+    std::unordered_map<std::string, std::uint32_t, IdHash, std::equal_to<>> m_idDictionary;
+    std::size_t m_idBytes;                                      // Total length of m_idEntries
+    std::vector<std::int32_t> m_data;
+};
+
+/* Decodes blocks written by ArchiveWriter, a whole block at a time
+   Each column is unpacked into a flat array, then the arrays are combined into events. Unpacking loads the word
+   holding each value and shifts it into place; with AVX2 four values are gathered and shifted at once. Ids are views
+   into the archive, which must outlive the events; use each library's makeEvent() to build a real event from one.
+   Throws std::runtime_error on a truncated or corrupt block. */
+class ArchiveReader
+{
+public:
+    enum Unpack
+    {
+        AUTO = 0,                           // The widest the CPU supports
+        AVX2,
+        SCALAR
+    };
+
+    // Throws std::invalid_argument if the requested unpack is not supported here
+    explicit ArchiveReader(std::string_view data, Unpack unpack = AUTO);
+
+    // Replace events with the next block's. Returns false at the end of the archive
+    bool nextBlock(std::vector<ParsedEvent> & events);
+
+    /* As above, skipping blocks with no timestamp in [from, to) on their header alone
+       Events of a block that overlaps the range are all returned, so filter them with timeIn() if need be */
+    bool nextBlock(std::vector<ParsedEvent> & events, std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to);
+
+    // Blocks passed over by time range so far
+    std::size_t skippedBlocks() const { return m_skipped; }
+
+    static bool supported(Unpack unpack);
+
+private:
+    void decodeBlock(std::string_view block, std::size_t count, std::vector<ParsedEvent> & events);
+
+    std::string_view m_data;
+    std::size_t m_offset;
+    std::size_t m_skipped;
+    void (*m_unpack)(const char * packed, unsigned width, std::size_t count, std::uint64_t * values);
+
+    // Decoded columns, kept to reuse their memory
+    std::vector<std::uint64_t> m_values;
+    std::vector<std::uint16_t> m_entries;
+    std::vector<std::string_view> m_ids;
+};
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_ARCHIVE_HPP
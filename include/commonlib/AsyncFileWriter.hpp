@@ -0,0 +1,107 @@
+#ifndef COMMONLIB_ASYNCFILEWRITER_HPP
+#define COMMONLIB_ASYNCFILEWRITER_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace commonlib
+{
+
+struct AsyncFileWriterOptions
+{
+    enum Backend
+    {
+        AUTO = 0,                           // io_uring when the kernel allows it and can write with it, else pwritev
+        IO_URING,
+        PWRITEV
+    };
+
+    std::size_t bufferSize_ = 1 << 20;      // Bytes per buffer, rounded up to a whole number of blocks
+    std::size_t bufferCount_ = 4;           // Buffers being filled or written, at least 2
+    bool directIO_ = false;                 // Open with O_DIRECT. Ignored where the file system does not support it
+    Backend backend_ = AUTO;
+};
+
+/* Writes whole buffers to a file in the background while the caller fills the next one
+   The writer owns a fixed set of buffers. acquire() hands out a free one, blocking until a write completes if none
+   are free, and submit() queues it to be written after everything submitted before it, whatever order the buffers
+   were acquired in. Not thread safe: one producer thread owns the writer. Write errors are thrown as std::system_error from the next call. */
+class AsyncFileWriter
+{
+public:
+    struct Buffer
+    {
+        char * data_;                       // Aligned to the block size
+        std::size_t capacity_;              // Multiple of the block size
+        std::size_t size_;                  // Bytes filled by the caller
+        unsigned index_;                    // Owned by the writer
+    };
+
+    // Alignment of buffers and file offsets, as O_DIRECT requires
+    static constexpr std::size_t BlockSize = 4096;
+
+    virtual ~AsyncFileWriter() = default;
+
+    /* Get an empty buffer to fill
+       Throws std::logic_error if the caller holds every buffer, since none could ever come back to wait for */
+    virtual Buffer * acquire() = 0;
+
+    /* Queue a filled buffer to be appended to the file
+       With direct I/O every buffer but the last must hold a multiple of BlockSize bytes. */
+    virtual void submit(Buffer * buffer) = 0;
+
+    // Wait until everything submitted so far is written
+    virtual void flush() = 0;
+
+    /* Write the optional last buffer, which may be partly filled, wait for all writes and close the file
+       Called by the destructor if needed, where errors are lost. */
+    virtual void close(Buffer * last = nullptr) = 0;
+
+    virtual const char * backendName() const = 0;
+    virtual bool directIO() const = 0;
+};
+
+// Create or truncate the file at path. Throws std::system_error if it cannot be opened
+std::unique_ptr<AsyncFileWriter> openAsyncFileWriter(const std::string & path, const AsyncFileWriterOptions & options = {});
+
+/* Event sink writing through an AsyncFileWriter
+   Formatting goes into the buffer the writer handed out, which is submitted once full, so formatting the next events
+   overlaps with writing the previous ones. */
+class AsyncFileSink
+{
+public:
+    explicit AsyncFileSink(AsyncFileWriter & writer);
+    ~AsyncFileSink();
+
+    AsyncFileSink(const AsyncFileSink &) = delete;
+    AsyncFileSink & operator=(const AsyncFileSink &) = delete;
+
+    void append(std::string_view text)
+    {
+        if(text.size() <= m_buffer->capacity_ - m_buffer->size_)
+        {
+            std::char_traits<char>::copy(m_buffer->data_ + m_buffer->size_, text.data(), text.size());
+            m_buffer->size_ += text.size();
+            return;
+        }
+        appendSlow(text);
+    }
+
+    // Submit what has been appended so far and wait for it to be written
+    void flush();
+
+    // Write out the remainder and close the file
+    void close();
+
+private:
+    void appendSlow(std::string_view text);
+
+    AsyncFileWriter & m_writer;
+    AsyncFileWriter::Buffer * m_buffer;     // Buffer being filled, null once closed
+};
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_ASYNCFILEWRITER_HPP
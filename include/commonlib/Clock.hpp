@@ -0,0 +1,125 @@
+#ifndef COMMONLIB_CLOCK_HPP
+#define COMMONLIB_CLOCK_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <thread>
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+namespace commonlib
+{
+
+/* Anything producers can stamp events' timestamp_ from
+   All three libraries take the timestamp as a constructor argument, so code that makes events is a template on the
+   clock, as the handlers are on the sink, and the cheap clocks below inline into it. */
+template <class C>
+concept TimestampClock = requires(C & clock)
+{
+    { clock.now() } -> std::same_as<std::chrono::system_clock::time_point>;
+};
+
+// The reference: one vDSO call per stamp
+struct SystemClock
+{
+    std::chrono::system_clock::time_point now() const { return std::chrono::system_clock::now(); }
+};
+
+/* Wall time extrapolated from the CPU's time stamp counter
+   The tick rate is measured against steady_clock at construction, and the wall time is taken again from system_clock
+   every resync interval, at which point the rate is refined over everything seen so far. A stamp is then a rdtsc
+   and a multiply. Never goes backwards: after a resync that puts the time back, stamps hold until it catches up.
+
+   Not thread safe, and only monotonic per instance: give each producing thread its own. Needs an invariant TSC;
+   the constructor throws std::runtime_error without one. */
+class TscClock
+{
+public:
+    using WallClock = std::function<std::chrono::system_clock::time_point()>;
+    using Counter = std::function<std::uint64_t()>;
+
+    explicit TscClock(std::chrono::nanoseconds resyncInterval = std::chrono::seconds(1));
+
+    /* As above, reading wall time from wallClock rather than system_clock and, if given, ticks from counter rather
+       than the TSC, so tests can step the time and choose the rate. No invariant TSC is needed with a counter */
+    TscClock(std::chrono::nanoseconds resyncInterval, WallClock wallClock, Counter counter = {});
+
+    std::chrono::system_clock::time_point now()
+    {
+        std::uint64_t tsc = readCounter();
+        if(tsc >= m_resyncAt) [[unlikely]]
+        {
+            resync();
+            // The resync read the counter again, after tsc, and measures from there
+            tsc = m_baseTsc;
+        }
+        const auto elapsed = static_cast<std::int64_t>(static_cast<double>(tsc - m_baseTsc) * m_nanosecondsPerTick);
+        const std::int64_t nanoseconds = std::max(m_baseNanoseconds + elapsed, m_floorNanoseconds);
+        return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::nanoseconds(nanoseconds)));
+    }
+
+    double ticksPerSecond() const { return 1e9 / m_nanosecondsPerTick; }
+
+    static bool supported();
+
+private:
+    static std::uint64_t readTsc()
+    {
+#if defined(__x86_64__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    // A well predicted branch when there is no injected counter
+    std::uint64_t readCounter() const { return m_counter ? m_counter() : readTsc(); }
+
+    void resync();
+
+    std::uint64_t m_resyncTicks;            // Resync interval in ticks
+    std::uint64_t m_resyncAt;
+    std::uint64_t m_baseTsc;                // Counter at the last resync
+    std::int64_t m_baseNanoseconds;         // Wall time at the last resync
+    std::int64_t m_floorNanoseconds;        // Latest time handed out before the last resync
+    double m_nanosecondsPerTick;
+    std::uint64_t m_calibrationTsc;         // Counter and steady time at construction, to refine the rate from
+    std::chrono::steady_clock::time_point m_calibrationSteady;
+    WallClock m_wallClock;                  // Read only at construction and on resync
+    Counter m_counter;                      // Empty for the TSC
+};
+
+/* The last wall time a background thread read, one atomic load per stamp
+   The thread reads system_clock every resolution, so stamps lag by up to that plus any scheduling delay. Never goes
+   backwards. Safe to share between threads. */
+class CoarseClock
+{
+public:
+    explicit CoarseClock(std::chrono::microseconds resolution = std::chrono::microseconds(100));
+    ~CoarseClock();
+
+    CoarseClock(const CoarseClock &) = delete;
+    CoarseClock & operator=(const CoarseClock &) = delete;
+
+    std::chrono::system_clock::time_point now() const
+    {
+        return std::chrono::system_clock::time_point(std::chrono::system_clock::duration(m_now.load(std::memory_order_relaxed)));
+    }
+
+private:
+    void update(std::chrono::microseconds resolution);
+
+    alignas(64) std::atomic<std::chrono::system_clock::rep> m_now;   // Read by every producer, on a line of its own
+    alignas(64) std::atomic<bool> m_stop;
+    std::thread m_updater;
+};
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_CLOCK_HPP
@@ -0,0 +1,63 @@
+#ifndef COMMONLIB_DEDUPFILTER_HPP
+#define COMMONLIB_DEDUPFILTER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+namespace commonlib
+{
+
+struct DedupFilterOptions
+{
+    std::size_t expectedEventsPerWindow_ = 1000000;         // Distinct events seen in one window
+    double falsePositiveRate_ = 0.01;                       // Chance a new event is wrongly taken as a duplicate
+    std::chrono::steady_clock::duration window_ = std::chrono::seconds(60);
+};
+
+/* Drops events whose fingerprint has been seen recently, using a blocked Bloom filter with bounded memory
+   Two generations are kept and both are checked. Inserts go to the current one, and once it is a window old the
+   previous generation is cleared and the two swap, so a fingerprint is remembered for between one and two windows.
+   Each fingerprint touches one 64 byte block, a single cache line.
+
+   Safe to call from several threads: bits are set with atomic or. Two threads admitting the same new fingerprint at
+   once may both be told it is new, and an insert racing with a generation swap may be lost. Both only let a
+   duplicate through; a new event is never dropped other than by a false positive. */
+class DedupFilter
+{
+public:
+    explicit DedupFilter(const DedupFilterOptions & options = {});
+
+    /* Record the fingerprint and return true if it was not seen in the last window or two
+       now drives the window rotation and must not go backwards by more than a window */
+    bool admit(std::uint64_t fingerprint, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    // Bytes of filter memory, fixed at construction
+    std::size_t memoryBytes() const;
+
+    int hashesPerFingerprint() const { return m_hashes; }
+
+private:
+    static constexpr std::size_t WordsPerBlock = 8;         // 512 bits, one cache line
+
+    struct alignas(64) Block
+    {
+        std::atomic<std::uint64_t> words_[WordsPerBlock];
+    };
+
+    void rotate(std::chrono::steady_clock::time_point now);
+
+    std::size_t m_blocks;                                   // Blocks per generation
+    int m_hashes;                                           // Bits set per fingerprint
+    std::chrono::steady_clock::duration m_window;
+    std::unique_ptr<Block[]> m_generations[2];
+    std::atomic<int> m_current;                             // Index of the generation taking inserts
+    std::atomic<std::chrono::steady_clock::rep> m_rotateAt; // When the current generation is a window old
+    std::mutex m_rotateMutex;
+};
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_DEDUPFILTER_HPP
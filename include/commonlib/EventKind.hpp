@@ -0,0 +1,42 @@
+#ifndef COMMONLIB_EVENTKIND_HPP
+#define COMMONLIB_EVENTKIND_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace commonlib
+{
+
+/* The concrete event types, named the same way in every library
+   Lets code in front of the libraries (scheduling, sampling, load generation) key on the type without depending on
+   any one library's representation of it. */
+enum class EventKind : std::uint8_t
+{
+    SESSION_START = 0,
+    SESSION_END,
+    AUTH_LOGIN,
+    AUTH_LOGOUT
+};
+
+constexpr std::size_t EventKindCount = 4;
+
+constexpr std::size_t kindIndex(EventKind kind)
+{
+    return static_cast<std::size_t>(kind);
+}
+
+constexpr const char * kindName(EventKind kind)
+{
+    switch(kind)
+    {
+        case EventKind::SESSION_START: return "SESSION_START";
+        case EventKind::SESSION_END:   return "SESSION_END";
+        case EventKind::AUTH_LOGIN:    return "AUTH_LOGIN";
+        case EventKind::AUTH_LOGOUT:   return "AUTH_LOGOUT";
+    }
+    return "UNKNOWN";
+}
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_EVENTKIND_HPP
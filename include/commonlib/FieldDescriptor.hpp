@@ -0,0 +1,159 @@
+#ifndef COMMONLIB_FIELDDESCRIPTOR_HPP
+#define COMMONLIB_FIELDDESCRIPTOR_HPP
+
+#include "commonlib/EventKind.hpp"
+#include "commonlib/Sink.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace commonlib
+{
+
+enum class FieldType : std::uint8_t
+{
+    INT16 = 0,
+    INT32,
+    TIMESTAMP,                              // std::chrono::system_clock::time_point
+    STRING                                  // std::string
+};
+
+/* One data member of an event type
+   The events are not standard layout (virtual functions, virtual bases, std::string members), so offsetof is not
+   valid on them. Each field instead has a small accessor, instantiated from a chain of member pointers, that takes
+   the concrete event and returns the address of the member. */
+struct FieldDescriptor
+{
+    const char * name_;                     // Member name without the trailing underscore, or what the other libraries call it
+    const char * label_;                    // Text written before the value by the formatter
+    FieldType type_;
+    const void * (*address_)(const void * object);
+};
+
+// All fields of one concrete event type, in the order they are formatted and encoded
+struct TypeDescriptor
+{
+    const char * name_;
+    EventKind kind_;
+    std::span<const FieldDescriptor> fields_;
+};
+
+// A concrete event paired with its descriptor, as returned by each library's describe()
+struct DescribedEvent
+{
+    const TypeDescriptor * type_;
+    const void * object_;                   // Points at the concrete type, not at a base
+};
+
+// Address of object.*m1.*m2..., so fields of nested structs can be described too
+template <class Object, auto... Members>
+const void * memberAddress(const void * object)
+{
+    return &(*static_cast<const Object *>(object) .* ... .* Members);
+}
+
+template <class T>
+constexpr FieldType fieldTypeOf()
+{
+    if constexpr (std::is_same_v<T, short>)
+    {
+        return FieldType::INT16;
+    }
+    else if constexpr (std::is_same_v<T, int>)
+    {
+        return FieldType::INT32;
+    }
+    else if constexpr (std::is_same_v<T, std::chrono::system_clock::time_point>)
+    {
+        return FieldType::TIMESTAMP;
+    }
+    else
+    {
+        static_assert(std::is_same_v<T, std::string>, "Field type has no FieldType");
+        return FieldType::STRING;
+    }
+}
+
+// Describe the member reached from Object through Members, taking its FieldType from the member's declared type
+template <class Object, auto... Members>
+constexpr FieldDescriptor describeField(const char * name, const char * label)
+{
+    using Value = std::remove_cvref_t<decltype((std::declval<const Object &>() .* ... .* Members))>;
+    return FieldDescriptor{ name, label, fieldTypeOf<Value>(), &memberAddress<Object, Members...> };
+}
+
+/* Format an event by walking its descriptor: one line of label then value per field
+   The libraries' descriptors use the labels their handlers write, so the output is the same as handleEvent's. */
+template <EventSink Sink>
+void formatDescribed(Sink & sink, const DescribedEvent & event)
+{
+    for(const auto & field : event.type_->fields_)
+    {
+        const void * value = field.address_(event.object_);
+        sink.append(field.label_);
+        switch(field.type_)
+        {
+            case FieldType::INT16:     appendInteger(sink, *static_cast<const short *>(value)); break;
+            case FieldType::INT32:     appendInteger(sink, *static_cast<const int *>(value)); break;
+            case FieldType::TIMESTAMP: appendTimestamp(sink, *static_cast<const std::chrono::system_clock::time_point *>(value)); break;
+            case FieldType::STRING:    sink.append(*static_cast<const std::string *>(value)); break;
+        }
+        sink.append("\n");
+    }
+}
+
+template <EventSink Sink, std::integral T>
+void appendLittleEndian(Sink & sink, T value)
+{
+    using Unsigned = std::make_unsigned_t<T>;
+    char bytes[sizeof(T)];
+    for(std::size_t i = 0; i < sizeof(T); ++i)
+    {
+        bytes[i] = static_cast<char>(static_cast<Unsigned>(value) >> (8 * i));
+    }
+    sink.append(std::string_view(bytes, sizeof(T)));
+}
+
+/* Encode an event in binary by walking its descriptor
+   One byte of EventKind, then each field in descriptor order, little endian: INT16 and INT32 as themselves,
+   TIMESTAMP as signed 64 bit nanoseconds since the epoch, STRING as a 32 bit length then the bytes. */
+template <EventSink Sink>
+void encodeDescribed(Sink & sink, const DescribedEvent & event)
+{
+    appendLittleEndian(sink, static_cast<std::uint8_t>(event.type_->kind_));
+    for(const auto & field : event.type_->fields_)
+    {
+        const void * value = field.address_(event.object_);
+        switch(field.type_)
+        {
+            case FieldType::INT16:
+                appendLittleEndian(sink, *static_cast<const short *>(value));
+                break;
+            case FieldType::INT32:
+                appendLittleEndian(sink, *static_cast<const int *>(value));
+                break;
+            case FieldType::TIMESTAMP:
+            {
+                auto timestamp = *static_cast<const std::chrono::system_clock::time_point *>(value);
+                appendLittleEndian(sink, static_cast<std::int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count()));
+                break;
+            }
+            case FieldType::STRING:
+            {
+                const auto & text = *static_cast<const std::string *>(value);
+                appendLittleEndian(sink, static_cast<std::uint32_t>(text.size()));
+                sink.append(text);
+                break;
+            }
+        }
+    }
+}
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_FIELDDESCRIPTOR_HPP
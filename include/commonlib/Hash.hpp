@@ -0,0 +1,52 @@
+#ifndef COMMONLIB_HASH_HPP
+#define COMMONLIB_HASH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace commonlib
+{
+
+// Finalizer from MurmurHash3, spreading every input bit over the whole result
+constexpr std::uint64_t mixHash(std::uint64_t value)
+{
+    value ^= value >> 33;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33;
+    value *= 0xc4ceb9fe1a85ec53ULL;
+    value ^= value >> 33;
+    return value;
+}
+
+// Fold another value into a running hash
+constexpr std::uint64_t combineHash(std::uint64_t hash, std::uint64_t value)
+{
+    return mixHash(hash ^ (value + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2)));
+}
+
+/* Hash a string eight bytes at a time
+   Not cryptographic. Meant for fingerprints and sampling decisions on short ids. */
+inline std::uint64_t hashBytes(std::string_view bytes, std::uint64_t seed = 0)
+{
+    std::uint64_t hash = seed ^ (bytes.size() * 0x9e3779b97f4a7c15ULL);
+    const char * data = bytes.data();
+    std::size_t remaining = bytes.size();
+
+    while(remaining >= 8)
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data, 8);
+        hash = (hash ^ mixHash(word)) * 0x9fb21c651e98df25ULL;
+        data += 8;
+        remaining -= 8;
+    }
+
+    std::uint64_t tail = 0;
+    std::memcpy(&tail, data, remaining);
+    return mixHash(hash ^ tail);
+}
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_HASH_HPP
@@ -0,0 +1,92 @@
+#ifndef COMMONLIB_JSON_HPP
+#define COMMONLIB_JSON_HPP
+
+#include "commonlib/FieldDescriptor.hpp"
+#include "commonlib/Sink.hpp"
+#include "commonlib/Timestamp.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace commonlib
+{
+
+/* Length of the longest prefix of text that can go into a JSON string as it is
+   Checks 16 bytes at a time with SSE2 for quotes, backslashes and control characters. Bytes from 0x80 up are taken
+   to be UTF-8 and left alone. */
+std::size_t jsonCleanPrefix(std::string_view text);
+
+/* Write text as a quoted JSON string
+   Text with nothing to escape, which is every id in practice, is appended in one piece. Otherwise the clean runs are
+   appended between escapes. */
+template <EventSink Sink>
+void appendJsonString(Sink & sink, std::string_view text)
+{
+    sink.append("\"");
+    for(;;)
+    {
+        const std::size_t clean = jsonCleanPrefix(text);
+        sink.append(text.substr(0, clean));
+        if(clean == text.size())
+        {
+            break;
+        }
+
+        const unsigned char special = static_cast<unsigned char>(text[clean]);
+        switch(special)
+        {
+            case '"':  sink.append("\\\""); break;
+            case '\\': sink.append("\\\\"); break;
+            case '\b': sink.append("\\b"); break;
+            case '\f': sink.append("\\f"); break;
+            case '\n': sink.append("\\n"); break;
+            case '\r': sink.append("\\r"); break;
+            case '\t': sink.append("\\t"); break;
+            default:
+            {
+                const char hex[] = "0123456789abcdef";
+                const char escape[] = { '\\', 'u', '0', '0', hex[special >> 4], hex[special & 0xf] };
+                sink.append(std::string_view(escape, sizeof(escape)));
+                break;
+            }
+        }
+        text.remove_prefix(clean + 1);
+    }
+    sink.append("\"");
+}
+
+/* Write an event as one line of JSON by walking its descriptor
+   {"type":"SessionStartEvent","pid":9876,"timestamp":"2024-01-02T03:04:05.123456Z","sessionId":"...","someSpecificData":42}
+   Keys are the descriptor's field names and the timestamp is ISO 8601 in UTC. */
+template <EventSink Sink>
+void formatJson(Sink & sink, const DescribedEvent & event)
+{
+    sink.append("{\"type\":\"");
+    sink.append(event.type_->name_);
+    sink.append("\"");
+    for(const auto & field : event.type_->fields_)
+    {
+        const void * value = field.address_(event.object_);
+        sink.append(",\"");
+        sink.append(field.name_);
+        sink.append("\":");
+        switch(field.type_)
+        {
+            case FieldType::INT16:     appendInteger(sink, *static_cast<const short *>(value)); break;
+            case FieldType::INT32:     appendInteger(sink, *static_cast<const int *>(value)); break;
+            case FieldType::TIMESTAMP:
+                sink.append("\"");
+                sink.append(formatIsoTimestamp(*static_cast<const std::chrono::system_clock::time_point *>(value)));
+                sink.append("\"");
+                break;
+            case FieldType::STRING:    appendJsonString(sink, *static_cast<const std::string *>(value)); break;
+        }
+    }
+    sink.append("}\n");
+}
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_JSON_HPP
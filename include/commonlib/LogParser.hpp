@@ -0,0 +1,74 @@
+#ifndef COMMONLIB_LOGPARSER_HPP
+#define COMMONLIB_LOGPARSER_HPP
+
+#include "commonlib/EventKind.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace commonlib
+{
+
+// One event read back from handler output. Library neutral, and the id points into the parsed text
+struct ParsedEvent
+{
+    EventKind kind_;
+    short pid_;
+    std::chrono::system_clock::time_point timestamp_;   // Whole seconds, as written
+    std::string_view id_;                               // Session id or user id
+    int someSpecificData_;
+    double weight_;                                     // From a following "Sample weight is" line, otherwise 1
+};
+
+/* Reads events back from text in the format any of the three libraries' handleEvent writes
+   Lines are split 64 bytes at a time: a SIMD compare against '\n' gives a bit mask of line ends for the block, and
+   lines are then taken off the mask without looking at the bytes again. Each line's field is recognised by its
+   fixed prefix, and the specific data label tells both the event type and which library wrote it.
+
+   Events are returned as views into the text, which must outlive them; use each library's makeEvent() to build a
+   real event from one. A record that does not parse is skipped up to the next "PID is" line and counted. An identical
+   second "PID is" line, as older templatecastlib builds wrote, is accepted as part of the record. */
+class LogParser
+{
+public:
+    enum Scan
+    {
+        AUTO = 0,                           // The widest the CPU supports
+        AVX2,
+        SSE2,
+        SCALAR
+    };
+
+    // Throws std::invalid_argument if the requested scan is not supported here
+    explicit LogParser(std::string_view text, Scan scan = AUTO);
+
+    // Parse the next event into event. Returns false at the end of the text
+    bool next(ParsedEvent & event);
+
+    // Records and stray lines skipped so far
+    std::size_t malformed() const { return m_malformed; }
+
+    static bool supported(Scan scan);
+
+private:
+    static constexpr std::size_t BlockSize = 64;
+
+    bool nextLine(std::string_view & line);
+    bool parseRecord(std::string_view pidLine, ParsedEvent & event);
+
+    std::string_view m_text;
+    std::uint64_t (*m_scan)(const char * block);        // Bit i set if block[i] is a newline
+    std::size_t m_blockStart;                           // Offset of the block m_newlines covers
+    std::size_t m_nextBlock;                            // Offset of the next block to scan
+    std::uint64_t m_newlines;                           // Line ends in the current block not yet taken
+    std::size_t m_lineStart;                            // Offset of the next line
+    std::string_view m_pending;                         // A line read ahead and given back
+    bool m_hasPending;
+    std::size_t m_malformed;
+};
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_LOGPARSER_HPP
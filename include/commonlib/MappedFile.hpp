@@ -0,0 +1,32 @@
+#ifndef COMMONLIB_MAPPEDFILE_HPP
+#define COMMONLIB_MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace commonlib
+{
+
+/* A whole file mapped read only into memory
+   Views into text() stay valid for the lifetime of the object. The kernel is told the file will be read in order,
+   so it reads ahead aggressively. Throws std::system_error if the file cannot be opened or mapped. */
+class MappedFile
+{
+public:
+    explicit MappedFile(const std::string & path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile & operator=(const MappedFile &) = delete;
+
+    std::string_view text() const { return std::string_view(m_data, m_size); }
+
+private:
+    const char * m_data;                    // Null for an empty file, which cannot be mapped
+    std::size_t m_size;
+};
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_MAPPEDFILE_HPP
@@ -0,0 +1,184 @@
+#ifndef COMMONLIB_PIPELINE_HPP
+#define COMMONLIB_PIPELINE_HPP
+
+#include "commonlib/EventKind.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace commonlib
+{
+
+enum class StageType
+{
+    FILTER,                                 // Drops items the predicate rejects
+    ENRICH,                                 // Updates the item in place, or replaces it with what it returns
+    DISPATCH                                // Terminal, hands the item on
+};
+
+template <class Predicate>
+struct FilterStage
+{
+    static constexpr StageType Type = StageType::FILTER;
+    Predicate predicate_;
+};
+
+template <class Function>
+struct EnrichStage
+{
+    static constexpr StageType Type = StageType::ENRICH;
+    Function function_;
+};
+
+template <class Function>
+struct DispatchStage
+{
+    static constexpr StageType Type = StageType::DISPATCH;
+    Function function_;
+};
+
+// predicate(const Item &) returns whether the item goes on
+template <class Predicate>
+FilterStage<Predicate> filter(Predicate predicate)
+{
+    return { std::move(predicate) };
+}
+
+/* function(Item &) either returns void, having updated the item, or returns the value the following stages see
+   instead, so an enrichment can attach data to an event without touching the event types */
+template <class Function>
+EnrichStage<Function> enrich(Function function)
+{
+    return { std::move(function) };
+}
+
+// function(Item &) consumes the item, typically by calling a library's handleEvent
+template <class Function>
+DispatchStage<Function> dispatch(Function function)
+{
+    return { std::move(function) };
+}
+
+/* A chain of stages composed at compile time with operator|, ending in a dispatch
+   run() makes one pass over a batch and pushes each item through every stage before taking the next one. Stages are
+   members of the pipeline's type, so the compiler sees the whole chain and inlines it into a single loop body: nothing
+   is materialized between stages and a filtered out item costs no more than the predicates it failed. */
+template <class... Stages>
+class Pipeline
+{
+public:
+    explicit Pipeline(std::tuple<Stages...> stages)
+        : m_stages(std::move(stages))
+    {}
+
+    // Pass every item of the batch through the stages. Returns how many reached the dispatch
+    template <class Batch>
+    std::size_t run(Batch && batch)
+    {
+        static_assert(std::tuple_element_t<sizeof...(Stages) - 1, std::tuple<Stages...>>::Type == StageType::DISPATCH,
+                      "A pipeline must end in a dispatch stage");
+
+        std::size_t dispatched = 0;
+        for(auto && item : batch)
+        {
+            dispatched += push<0>(item) ? 1 : 0;
+        }
+        return dispatched;
+    }
+
+    template <class Stage>
+    friend Pipeline<Stages..., Stage> operator|(Pipeline pipeline, Stage stage)
+    {
+        return Pipeline<Stages..., Stage>(std::tuple_cat(std::move(pipeline.m_stages), std::make_tuple(std::move(stage))));
+    }
+
+private:
+    template <std::size_t Index, class Item>
+    bool push(Item && item)
+    {
+        auto & stage = std::get<Index>(m_stages);
+        using Stage = std::tuple_element_t<Index, std::tuple<Stages...>>;
+
+        if constexpr (Stage::Type == StageType::FILTER)
+        {
+            if(!stage.predicate_(std::as_const(item)))
+            {
+                return false;
+            }
+            return push<Index + 1>(item);
+        }
+        else if constexpr (Stage::Type == StageType::ENRICH)
+        {
+            if constexpr (std::is_void_v<decltype(stage.function_(item))>)
+            {
+                stage.function_(item);
+                return push<Index + 1>(item);
+            }
+            else
+            {
+                return push<Index + 1>(stage.function_(item));
+            }
+        }
+        else
+        {
+            static_assert(Index + 1 == sizeof...(Stages), "Nothing can follow a dispatch stage");
+            stage.function_(item);
+            return true;
+        }
+    }
+
+    std::tuple<Stages...> m_stages;
+};
+
+template <class First, class Second>
+    requires requires { First::Type; Second::Type; }
+Pipeline<First, Second> operator|(First first, Second second)
+{
+    return Pipeline<First, Second>(std::make_tuple(std::move(first), std::move(second)));
+}
+
+/* Predicates on any library's events, for use with filter()
+   Items may be raw or smart pointers. The library's eventKind, eventPid and eventTimestamp are found by argument
+   dependent lookup on the event pointer. */
+inline auto kindIn(std::initializer_list<EventKind> kinds)
+{
+    std::uint32_t mask = 0;
+    for(auto kind : kinds)
+    {
+        mask |= 1u << kindIndex(kind);
+    }
+    return [mask](const auto & item)
+    {
+        return ((mask >> kindIndex(eventKind(std::to_address(item)))) & 1u) != 0;
+    };
+}
+
+// Process ids in [low, high]
+inline auto pidIn(short low, short high)
+{
+    return [low, high](const auto & item)
+    {
+        const short pid = eventPid(std::to_address(item));
+        return pid >= low && pid <= high;
+    };
+}
+
+// Timestamps in [from, to)
+inline auto timeIn(std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to)
+{
+    return [from, to](const auto & item)
+    {
+        const auto timestamp = eventTimestamp(std::to_address(item));
+        return timestamp >= from && timestamp < to;
+    };
+}
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_PIPELINE_HPP
@@ -0,0 +1,198 @@
+#ifndef COMMONLIB_PRIORITYDISPATCHER_HPP
+#define COMMONLIB_PRIORITYDISPATCHER_HPP
+
+#include "commonlib/EventKind.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <stdexcept>
+#include <utility>
+
+namespace commonlib
+{
+
+struct KindPolicy
+{
+    enum Shed
+    {
+        DROP_NEWEST = 0,                    // Refuse the event being submitted
+        DROP_OLDEST                         // Evict the event that has waited longest to make room
+    };
+
+    unsigned priority_ = 0;                 // Lower is served first. Kinds of equal priority share one arrival order
+    double ratePerSecond_ = 0.0;            // Token bucket refill rate, 0 for no quota
+    double burst_ = 0.0;                    // Tokens the bucket holds when full, at least 1 if there is a quota
+    std::size_t highWatermark_ = 0;         // Queued events past which the kind sheds, 0 for unbounded
+    Shed shed_ = DROP_NEWEST;
+};
+
+/* Queues events per kind and hands them to a library's handleEvent in priority order rather than arrival order
+   Each dispatch() call serves up to its budget of events, always from the most important kind with something queued
+   and a token to spend. A kind whose token bucket is empty waits for the refill even if nothing else is queued, so
+   a quota caps a kind's share of the handler during a storm instead of only reordering it. Once a kind has
+   highWatermark_ events queued it sheds according to its policy, and other kinds are unaffected.
+
+   EventPtr is whatever the caller hands to its library, typically a pointer or unique_ptr to the event. Not thread
+   safe: one thread owns the dispatcher and calls both submit() and dispatch(). */
+template <class EventPtr>
+class PriorityDispatcher
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Stats
+    {
+        std::uint64_t submitted_ = 0;
+        std::uint64_t dispatched_ = 0;
+        std::uint64_t dropped_ = 0;         // Shed at the watermark, either on submission or by eviction
+        std::uint64_t deferred_ = 0;        // dispatch() calls that left the kind queued for want of a token
+    };
+
+    explicit PriorityDispatcher(const std::array<KindPolicy, EventKindCount> & policies = {}, Clock::time_point now = Clock::now())
+    {
+        for(std::size_t kind = 0; kind < EventKindCount; ++kind)
+        {
+            const auto & policy = policies[kind];
+            if(policy.ratePerSecond_ < 0.0 || (policy.ratePerSecond_ > 0.0 && policy.burst_ < 1.0))
+            {
+                throw std::invalid_argument("A quota needs a positive rate and a burst of at least one event");
+            }
+            m_kinds[kind].policy_ = policy;
+            m_kinds[kind].tokens_ = policy.burst_;
+            m_kinds[kind].refilledAt_ = now;
+        }
+    }
+
+    /* Queue an event, or shed one if the kind is at its watermark
+       Returns false if the submitted event itself was dropped. */
+    bool submit(EventKind kind, EventPtr event, Clock::time_point now = Clock::now())
+    {
+        auto & state = m_kinds[kindIndex(kind)];
+        ++state.stats_.submitted_;
+
+        const auto watermark = state.policy_.highWatermark_;
+        if(watermark != 0 && state.queue_.size() >= watermark)
+        {
+            ++state.stats_.dropped_;
+            if(state.policy_.shed_ == KindPolicy::DROP_NEWEST)
+            {
+                return false;
+            }
+            state.queue_.pop_front();
+        }
+
+        state.queue_.push_back(Queued{ std::move(event), now, m_sequence++ });
+        return true;
+    }
+
+    /* Hand up to maxEvents queued events to handler(EventKind, EventPtr &, Clock::time_point enqueuedAt)
+       Returns the number dispatched, which is less than maxEvents when everything left is empty or out of tokens. */
+    template <class Handler>
+    std::size_t dispatch(std::size_t maxEvents, Handler && handler, Clock::time_point now = Clock::now())
+    {
+        for(auto & state : m_kinds)
+        {
+            refill(state, now);
+        }
+
+        std::size_t dispatched = 0;
+        while(dispatched < maxEvents)
+        {
+            KindState * next = nullptr;
+            for(auto & state : m_kinds)
+            {
+                if(state.queue_.empty() || !hasToken(state))
+                {
+                    continue;
+                }
+                if(!next || state.policy_.priority_ < next->policy_.priority_
+                   || (state.policy_.priority_ == next->policy_.priority_ && state.queue_.front().sequence_ < next->queue_.front().sequence_))
+                {
+                    next = &state;
+                }
+            }
+            if(!next)
+            {
+                break;
+            }
+
+            if(next->policy_.ratePerSecond_ > 0.0)
+            {
+                next->tokens_ -= 1.0;
+            }
+            Queued queued = std::move(next->queue_.front());
+            next->queue_.pop_front();
+            ++next->stats_.dispatched_;
+            ++dispatched;
+
+            handler(static_cast<EventKind>(next - m_kinds.data()), queued.event_, queued.enqueuedAt_);
+        }
+
+        for(auto & state : m_kinds)
+        {
+            if(!state.queue_.empty() && !hasToken(state))
+            {
+                ++state.stats_.deferred_;
+            }
+        }
+        return dispatched;
+    }
+
+    const Stats & stats(EventKind kind) const { return m_kinds[kindIndex(kind)].stats_; }
+
+    std::size_t queued(EventKind kind) const { return m_kinds[kindIndex(kind)].queue_.size(); }
+
+    std::size_t queued() const
+    {
+        std::size_t total = 0;
+        for(const auto & state : m_kinds)
+        {
+            total += state.queue_.size();
+        }
+        return total;
+    }
+
+private:
+    struct Queued
+    {
+        EventPtr event_;
+        Clock::time_point enqueuedAt_;
+        std::uint64_t sequence_;            // Arrival order across kinds, to break priority ties
+    };
+
+    struct KindState
+    {
+        KindPolicy policy_;
+        std::deque<Queued> queue_;
+        double tokens_ = 0.0;
+        Clock::time_point refilledAt_;
+        Stats stats_;
+    };
+
+    static bool hasToken(const KindState & state)
+    {
+        return state.policy_.ratePerSecond_ <= 0.0 || state.tokens_ >= 1.0;
+    }
+
+    static void refill(KindState & state, Clock::time_point now)
+    {
+        if(state.policy_.ratePerSecond_ <= 0.0 || now <= state.refilledAt_)
+        {
+            return;
+        }
+        const double elapsed = std::chrono::duration<double>(now - state.refilledAt_).count();
+        state.tokens_ = std::min(state.policy_.burst_, state.tokens_ + elapsed * state.policy_.ratePerSecond_);
+        state.refilledAt_ = now;
+    }
+
+    std::array<KindState, EventKindCount> m_kinds;
+    std::uint64_t m_sequence = 0;
+};
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_PRIORITYDISPATCHER_HPP
@@ -0,0 +1,108 @@
+#ifndef COMMONLIB_SAMPLER_HPP
+#define COMMONLIB_SAMPLER_HPP
+
+#include "commonlib/EventKind.hpp"
+#include "commonlib/Sink.hpp"
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+
+namespace commonlib
+{
+
+struct SamplingPolicy
+{
+    enum Mode
+    {
+        KEEP_ALL = 0,
+        FIXED,                              // Keep rate_ of the keys
+        ADAPTIVE                            // Keep about targetPerSecond_ events, adjusted on each update()
+    };
+
+    Mode mode_ = KEEP_ALL;
+    double rate_ = 1.0;                     // FIXED: fraction kept, in (0, 1]
+    double targetPerSecond_ = 0.0;          // ADAPTIVE: events per second to keep
+    double minRate_ = 1.0 / 1024;           // ADAPTIVE: lowest fraction it will go down to
+};
+
+struct SampleDecision
+{
+    bool keep_;
+    double weight_;                         // Events this one stands for, 1 / rate. Only set when kept
+};
+
+/* Decides per event kind whether to format an event, keeping a deterministic subset of sessions or users
+   The decision compares the top 32 bits of a hash of the event's session or user id (each library's samplingKey())
+   with a per kind threshold, so every event with the same id is kept or dropped together. Thresholds only move the
+   cut-off: lowering the rate drops the ids with the largest hashes and keeps the rest, so an adaptive rate does not
+   reshuffle which sessions are seen.
+
+   Adaptive kinds count the events offered and on each update() set their rate to the target over the observed rate,
+   smoothed over the previous interval. sample() reads no clock; the owner calls update() periodically, say every
+   100ms or every batch. Not thread safe: use one sampler per producer thread. */
+class Sampler
+{
+public:
+    explicit Sampler(const std::array<SamplingPolicy, EventKindCount> & policies = {}, std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    SampleDecision sample(EventKind kind, std::uint64_t key)
+    {
+        auto & state = m_kinds[kindIndex(kind)];
+        ++state.offered_;
+        if((key >> 32) < state.threshold_)
+        {
+            ++state.kept_;
+            return SampleDecision{ true, state.weight_ };
+        }
+        return SampleDecision{ false, 0.0 };
+    }
+
+    // Recompute the rate of adaptive kinds from the events offered since the last update
+    void update(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now());
+
+    // Fraction of keys currently kept
+    double rate(EventKind kind) const;
+
+    std::uint64_t offered(EventKind kind) const { return m_kinds[kindIndex(kind)].offered_; }
+    std::uint64_t kept(EventKind kind) const { return m_kinds[kindIndex(kind)].kept_; }
+
+private:
+    struct KindState
+    {
+        SamplingPolicy policy_;
+        std::uint64_t threshold_ = 0;       // Keys whose top 32 bits are below this are kept, 2^32 keeps all
+        double weight_ = 1.0;
+        std::uint64_t offered_ = 0;
+        std::uint64_t kept_ = 0;
+        std::uint64_t offeredAtUpdate_ = 0;
+        double observedPerSecond_ = 0.0;    // Smoothed offered rate, 0 until the first update
+    };
+
+    static void setRate(KindState & state, double rate);
+
+    std::array<KindState, EventKindCount> m_kinds;
+    std::chrono::steady_clock::time_point m_updatedAt;
+};
+
+/* Write the weight of a kept event after its record
+   Only written when the weight is above 1, so a reader takes a record without the line to stand for one event. */
+template <EventSink Sink>
+void appendSampleWeight(Sink & sink, double weight)
+{
+    if(weight <= 1.0)
+    {
+        return;
+    }
+
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), weight);
+    sink.append("Sample weight is ");
+    sink.append(std::string_view(buffer, static_cast<std::size_t>(result.ptr - buffer)));
+    sink.append("\n");
+}
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_SAMPLER_HPP
@@ -0,0 +1,102 @@
+#ifndef COMMONLIB_SINK_HPP
+#define COMMONLIB_SINK_HPP
+
+#include "commonlib/Timestamp.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+namespace commonlib
+{
+
+/* Anything the event handlers can write formatted text into
+   A std::string is a sink, as is any type with an append(std::string_view) member. The handlers are templates on the
+   sink, so a sink defined inline in a header lets the compiler inline all the way through the formatting. */
+template <class S>
+concept EventSink = requires(S & sink, std::string_view text)
+{
+    sink.append(text);
+};
+
+// Adapts a std::ostream to the sink interface. Every append is a virtual call into the stream buffer
+class OstreamSink
+{
+public:
+    explicit OstreamSink(std::ostream & out)
+        : m_out(out)
+    {}
+
+    void append(std::string_view text)
+    {
+        m_out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+private:
+    std::ostream & m_out;
+};
+
+// Collects the output in memory. Reserve up front so that appends never reallocate
+class BufferSink
+{
+public:
+    explicit BufferSink(std::size_t capacity = 0)
+    {
+        m_buffer.reserve(capacity);
+    }
+
+    void append(std::string_view text)
+    {
+        m_buffer.append(text);
+    }
+
+    const std::string & buffer() const { return m_buffer; }
+    std::size_t size() const { return m_buffer.size(); }
+
+    // Empty the buffer but keep its capacity
+    void clear() { m_buffer.clear(); }
+
+private:
+    std::string m_buffer;
+};
+
+// Discards the output and only counts it
+class CountingSink
+{
+public:
+    void append(std::string_view text)
+    {
+        m_bytes += text.size();
+        ++m_appends;
+    }
+
+    std::size_t bytes() const { return m_bytes; }
+    std::size_t appends() const { return m_appends; }
+
+private:
+    std::size_t m_bytes = 0;
+    std::size_t m_appends = 0;
+};
+
+template <EventSink Sink, std::integral T>
+void appendInteger(Sink & sink, T value)
+{
+    char buffer[24];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    sink.append(std::string_view(buffer, static_cast<std::size_t>(result.ptr - buffer)));
+}
+
+// Local time as %Y-%m-%d %H:%M:%S, the format every library writes
+template <EventSink Sink>
+void appendTimestamp(Sink & sink, std::chrono::system_clock::time_point timestamp)
+{
+    sink.append(formatLocalTimestamp(timestamp));
+}
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_SINK_HPP
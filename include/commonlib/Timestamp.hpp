@@ -0,0 +1,28 @@
+#ifndef COMMONLIB_TIMESTAMP_HPP
+#define COMMONLIB_TIMESTAMP_HPP
+
+#include <chrono>
+#include <string_view>
+
+namespace commonlib
+{
+
+/* Format a timestamp in local time as %Y-%m-%d %H:%M:%S
+   The result is cached per thread for the last second formatted, so a burst of events from the same second only pays
+   for the time zone conversion once. The returned view is valid until the next call on the same thread. */
+std::string_view formatLocalTimestamp(std::chrono::system_clock::time_point timestamp);
+
+/* Format a timestamp in UTC as ISO 8601 with microseconds, %Y-%m-%dT%H:%M:%S.ffffffZ
+   The date and time of day are cached per thread for the last second formatted, as for formatLocalTimestamp. The
+   returned view is valid until the next call on the same thread. */
+std::string_view formatIsoTimestamp(std::chrono::system_clock::time_point timestamp);
+
+/* Parse a local time written by formatLocalTimestamp, without strptime
+   The digits are read at fixed positions and the offset from UTC is looked up once per local hour, cached per thread.
+   Returns false if the text is not exactly in that format or not a valid date and time. In the hour that repeats when
+   daylight saving ends, the result is whichever instant mktime picks. */
+bool parseLocalTimestamp(std::string_view text, std::chrono::system_clock::time_point & timestamp);
+
+} // end namespace commonlib
+
+#endif // COMMONLIB_TIMESTAMP_HPP
@@ -1,9 +1,19 @@
 #ifndef PURECOMPLIB_EVENTS_HPP
 #define PURECOMPLIB_EVENTS_HPP
 
+#include "commonlib/EventKind.hpp"
+#include "commonlib/FieldDescriptor.hpp"
+#include "commonlib/Json.hpp"
+#include "commonlib/LogParser.hpp"
+#include "commonlib/Sink.hpp"
+
 #include <chrono>
+#include <cstdint>
 #include <iostream>
+#include <memory>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <variant>
 
 namespace purecomplib 
@@ -75,7 +85,163 @@ using AuthEvent = std::variant<AuthLoginEvent, AuthLogoutEvent>;
 using Event = std::variant<SessionEvent, AuthEvent>;
 
 
-/* Dispatcher for top level event into subtype handlers */
+/* Handler for auth events, writing into any sink */
+template <commonlib::EventSink Sink>
+void handleAuthEvent(const AuthEvent * authEvent, Sink & sink)
+{
+    if (!authEvent)
+    {
+        throw std::invalid_argument("authEvent pointer is null");
+    }
+
+    std::visit([&sink](auto && concreteEvent) 
+    {
+        using T = std::decay_t<decltype(concreteEvent)>;
+
+        // Handle event base data
+        sink.append("PID is ");
+        commonlib::appendInteger(sink, concreteEvent.authBaseData_.eventBaseData_.pid_);
+        sink.append("\nTimestamp is ");
+        commonlib::appendTimestamp(sink, concreteEvent.authBaseData_.eventBaseData_.timestamp_);
+        sink.append("\n");
+
+        // Handle auth event base data
+        sink.append("User is ");
+        sink.append(concreteEvent.authBaseData_.userId_);
+        sink.append("\n");
+
+        if constexpr (std::is_same_v<T, AuthLoginEvent>)
+        {
+            sink.append("Some specific data for AuthLoginEvent: ");
+        }
+        else if constexpr (std::is_same_v<T, AuthLogoutEvent>)
+        {
+            sink.append("Some specific data for AuthLogoutEvent: ");
+        }
+        else
+        {
+            throw std::runtime_error("Unknown AuthEvent type");
+        }
+        commonlib::appendInteger(sink, concreteEvent.someSpecificData_);
+        sink.append("\n");
+    }, *authEvent);
+}
+
+/* Handler for session events, writing into any sink */
+template <commonlib::EventSink Sink>
+void handleSessionEvent(const SessionEvent * sessionEvent, Sink & sink)
+{
+    if (!sessionEvent)
+    {
+        throw std::invalid_argument("sessionEvent pointer is null");
+    }
+
+    std::visit([&sink](auto && concreteEvent)
+    {
+        using T = std::decay_t<decltype(concreteEvent)>;
+
+        // Handle event base data
+        // concreteEvent.sessionBaseData_.eventBaseData_.pid_  is really inconvenient
+        sink.append("PID is ");
+        commonlib::appendInteger(sink, concreteEvent.sessionBaseData_.eventBaseData_.pid_);
+        sink.append("\nTimestamp is ");
+        commonlib::appendTimestamp(sink, concreteEvent.sessionBaseData_.eventBaseData_.timestamp_);
+        sink.append("\n");
+
+        // Handle session event base data
+        sink.append("Session id is ");
+        sink.append(concreteEvent.sessionBaseData_.sessionId_);
+        sink.append("\n");
+
+        if constexpr (std::is_same_v<T, SessionStartEvent>)
+        {
+            sink.append("Some specific data for SessionStartEvent: ");
+        }
+        else if constexpr (std::is_same_v<T, SessionEndEvent>)
+        {
+            sink.append("Some specific data for SessionEndEvent: ");
+        }
+        else
+        {
+            throw std::runtime_error("Unknown SessionEvent type");
+        }
+        commonlib::appendInteger(sink, concreteEvent.someSpecificData_);
+        sink.append("\n");
+    }, *sessionEvent);
+}
+
+/* Dispatcher for top level event into subtype handlers, writing into any sink */
+template <commonlib::EventSink Sink>
+void handleEvent(const Event * event, Sink & sink)
+{
+    if(!event)
+    {
+        throw std::invalid_argument("event pointer is null");
+    }
+
+    std::visit([&sink](auto && subtype) {
+        using T = std::decay_t<decltype(subtype)>;
+        if constexpr (std::is_same_v<T, AuthEvent>)
+        {
+            handleAuthEvent(&subtype, sink);
+        } 
+        else if constexpr (std::is_same_v<T, SessionEvent>)
+        {
+            handleSessionEvent(&subtype, sink);
+        }
+    }, *event);
+}
+
+/* Library neutral type of an event */
+commonlib::EventKind eventKind(const Event * event);
+
+/* Base data every event has, for code that does not care about the type */
+inline const EventBaseData & eventBaseData(const Event * event)
+{
+    return std::visit([](auto && subtype) -> const EventBaseData &
+    {
+        return std::visit([](auto && concreteEvent) -> const EventBaseData &
+        {
+            using T = std::decay_t<decltype(concreteEvent)>;
+            if constexpr (std::is_same_v<T, SessionStartEvent> || std::is_same_v<T, SessionEndEvent>)
+            {
+                return concreteEvent.sessionBaseData_.eventBaseData_;
+            }
+            else
+            {
+                return concreteEvent.authBaseData_.eventBaseData_;
+            }
+        }, subtype);
+    }, *event);
+}
+
+inline short eventPid(const Event * event) { return eventBaseData(event).pid_; }
+inline std::chrono::system_clock::time_point eventTimestamp(const Event * event) { return eventBaseData(event).timestamp_; }
+
+/* Rebuild an event read back from handler output by commonlib::LogParser */
+std::unique_ptr<Event> makeEvent(const commonlib::ParsedEvent & parsed);
+
+/* The concrete type's field descriptors and the event itself
+   Pass to commonlib::formatDescribed or commonlib::encodeDescribed */
+commonlib::DescribedEvent describe(const Event * event);
+
+/* Write an event as one line of JSON, the JSON lines counterpart of handleEvent */
+template <commonlib::EventSink Sink>
+void handleEventJson(const Event * event, Sink & sink)
+{
+    commonlib::formatJson(sink, describe(event));
+}
+
+/* Hash of the session or user id, the same for every event of one session or user
+   Used to sample whole sessions rather than single events */
+std::uint64_t samplingKey(const Event * event);
+
+/* Hash of the type, pid, timestamp, id and specific data of an event
+   Equal for every delivery of the same event, so it can be used to drop retried duplicates */
+std::uint64_t fingerprint(const Event * event);
+
+/* Dispatcher for top level event into subtype handlers
+   Thin wrapper over the sink version. The stream is flushed once per event */
 void handleEvent(const Event * event, std::ostream & out);
 
 } // end namespace eventlib
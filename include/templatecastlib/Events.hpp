@@ -1,9 +1,17 @@
 #ifndef TEMPLATECASTLIB_EVENTS_HPP
 #define TEMPLATECASTLIB_EVENTS_HPP
 
+#include "commonlib/EventKind.hpp"
+#include "commonlib/FieldDescriptor.hpp"
+#include "commonlib/Json.hpp"
+#include "commonlib/LogParser.hpp"
+#include "commonlib/Sink.hpp"
+
 #include <chrono>
+#include <cstdint>
 #include <iostream>
 #include <memory>
+#include <stdexcept>
 #include <string>
 #include <variant>
 
@@ -261,7 +269,128 @@ struct AuthLogoutEvent : public AuthEventBase, public EventID<AuthLogoutEvent, E
     AuthLogoutEvent(short pid, std::chrono::system_clock::time_point timestamp, const std::string & userId, int speceificData);
 };
 
+// Handler for session events, writing into any sink
+template <commonlib::EventSink Sink>
+void handleSessionEvent(const SessionEventBase * sessionEvent, Sink & sink)
+{
+    if(!sessionEvent)
+    {
+        throw std::invalid_argument("Session event pointer is null");
+    }
+
+    sink.append("Session id is ");
+    sink.append(sessionEvent->sessionId_);
+    sink.append("\n");
+
+    if(auto sessionStartEvent = sessionEvent->cast<SessionStartEvent>())
+    {
+        sink.append("Specific data for session start event: ");
+        commonlib::appendInteger(sink, sessionStartEvent->specificData_);
+        sink.append("\n");
+    }
+    else if(auto sessionEndEvent = sessionEvent->cast<SessionEndEvent>())
+    {
+        sink.append("Specific data for session end event: ");
+        commonlib::appendInteger(sink, sessionEndEvent->specificData_);
+        sink.append("\n");
+    }
+    else
+    {
+        throw std::invalid_argument("Unknown session event type encountered");
+    }
+}
+
+// Handler for auth events, writing into any sink
+template <commonlib::EventSink Sink>
+void handleAuthEvent(const AuthEventBase * authEvent, Sink & sink)
+{
+    if(!authEvent)
+    {
+        throw std::invalid_argument("Auth event pointer is null");
+    }
+
+    sink.append("User is ");
+    sink.append(authEvent->userId_);
+    sink.append("\n");
+
+    if(auto loginEvent = authEvent->cast<AuthLoginEvent>())
+    {
+        sink.append("Specific data for auth login event: ");
+        commonlib::appendInteger(sink, loginEvent->specificData_);
+        sink.append("\n");
+    }
+    else if(auto logoutEvent = authEvent->cast<AuthLogoutEvent>())
+    {
+        sink.append("Specific data for auth logout event: ");
+        commonlib::appendInteger(sink, logoutEvent->specificData_);
+        sink.append("\n");
+    }
+    else
+    {
+        throw std::invalid_argument("Unknown auth event type encountered");
+    }
+}
+
+// Dispatcher for top level event into subtype handlers, writing into any sink
+template <commonlib::EventSink Sink>
+void handleEvent(const Event * event, Sink & sink)
+{
+    if(!event)
+    {
+        throw std::invalid_argument("Event pointer is null");
+    }
+
+    sink.append("PID is ");
+    commonlib::appendInteger(sink, event->pid_);
+    sink.append("\nTimestamp is ");
+    commonlib::appendTimestamp(sink, event->timestamp_);
+    sink.append("\n");
+
+    if(auto sessionEvent = event->cast<SessionEventBase>())
+    {
+        handleSessionEvent(sessionEvent, sink);
+    }
+    else if(auto authEvent = event->cast<AuthEventBase>())
+    {
+        handleAuthEvent(authEvent, sink);
+    }
+    else
+    {
+        throw std::invalid_argument("Unknown event type encountered");
+    }
+}
+
+// Library neutral type of an event
+commonlib::EventKind eventKind(const Event * event);
+
+// Fields every event has, for code that does not care about the type
+inline short eventPid(const Event * event) { return event->pid_; }
+inline std::chrono::system_clock::time_point eventTimestamp(const Event * event) { return event->timestamp_; }
+
+// Rebuild an event read back from handler output by commonlib::LogParser
+std::unique_ptr<Event> makeEvent(const commonlib::ParsedEvent & parsed);
+
+// The concrete type's field descriptors and the event itself
+// Pass to commonlib::formatDescribed or commonlib::encodeDescribed
+commonlib::DescribedEvent describe(const Event * event);
+
+// Write an event as one line of JSON, the JSON lines counterpart of handleEvent
+template <commonlib::EventSink Sink>
+void handleEventJson(const Event * event, Sink & sink)
+{
+    commonlib::formatJson(sink, describe(event));
+}
+
+// Hash of the session or user id, the same for every event of one session or user
+// Used to sample whole sessions rather than single events
+std::uint64_t samplingKey(const Event * event);
+
+// Hash of the type, pid, timestamp, id and specific data of an event
+// Equal for every delivery of the same event, so it can be used to drop retried duplicates
+std::uint64_t fingerprint(const Event * event);
+
 // Dispatcher for top level event into subtype handlers
+// Thin wrapper over the sink version. The stream is flushed once per event
 void handleEvent(const Event * event, std::ostream & out);
 
 
@@ -0,0 +1,161 @@
+#include "alloctracklib/AllocTracker.hpp"
+
+#include <malloc.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+
+
+namespace alloctracklib
+{
+
+namespace
+{
+
+// Plain old data so that no TLS initialization can itself allocate
+thread_local AllocStats t_stats = {};
+
+void recordAllocation(void * pointer)
+{
+    auto size = malloc_usable_size(pointer);
+    ++t_stats.allocations_;
+    t_stats.bytesAllocated_ += size;
+    t_stats.liveBytes_ += static_cast<long long>(size);
+    t_stats.peakLiveBytes_ = std::max(t_stats.peakLiveBytes_, t_stats.liveBytes_);
+}
+
+void recordDeallocation(void * pointer)
+{
+    ++t_stats.deallocations_;
+    t_stats.liveBytes_ -= static_cast<long long>(malloc_usable_size(pointer));
+}
+
+void * allocate(std::size_t size)
+{
+    void * pointer = std::malloc(size ? size : 1);
+    if(pointer)
+    {
+        recordAllocation(pointer);
+    }
+    return pointer;
+}
+
+void * allocateAligned(std::size_t size, std::align_val_t alignment)
+{
+    auto align = static_cast<std::size_t>(alignment);
+    size = ((size ? size : 1) + align - 1) / align * align;   // aligned_alloc requires a multiple of the alignment
+
+    void * pointer = std::aligned_alloc(align, size);
+    if(pointer)
+    {
+        recordAllocation(pointer);
+    }
+    return pointer;
+}
+
+void deallocate(void * pointer)
+{
+    if(pointer)
+    {
+        recordDeallocation(pointer);
+        std::free(pointer);
+    }
+}
+
+} // end anonymous namespace
+
+AllocStats threadStats()
+{
+    return t_stats;
+}
+
+AllocScope::AllocScope()
+    : m_start(t_stats)
+    , m_outerPeak(t_stats.peakLiveBytes_)
+{
+    t_stats.peakLiveBytes_ = t_stats.liveBytes_;
+}
+
+AllocScope::~AllocScope()
+{
+    t_stats.peakLiveBytes_ = std::max(m_outerPeak, t_stats.peakLiveBytes_);
+}
+
+AllocStats AllocScope::stats() const
+{
+    return AllocStats
+    {
+        t_stats.allocations_ - m_start.allocations_,
+        t_stats.deallocations_ - m_start.deallocations_,
+        t_stats.bytesAllocated_ - m_start.bytesAllocated_,
+        t_stats.liveBytes_ - m_start.liveBytes_,
+        t_stats.peakLiveBytes_ - m_start.liveBytes_
+    };
+}
+
+} // end namespace alloctracklib
+
+
+// Replacements for every global allocation function. Linking alloctracklib into an executable turns tracking on
+
+void * operator new(std::size_t size)
+{
+    if(void * pointer = alloctracklib::allocate(size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void * operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void * operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    return alloctracklib::allocate(size);
+}
+
+void * operator new[](std::size_t size, const std::nothrow_t &) noexcept
+{
+    return alloctracklib::allocate(size);
+}
+
+void * operator new(std::size_t size, std::align_val_t alignment)
+{
+    if(void * pointer = alloctracklib::allocateAligned(size, alignment))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void * operator new[](std::size_t size, std::align_val_t alignment)
+{
+    return operator new(size, alignment);
+}
+
+void * operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return alloctracklib::allocateAligned(size, alignment);
+}
+
+void * operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept
+{
+    return alloctracklib::allocateAligned(size, alignment);
+}
+
+void operator delete(void * pointer) noexcept { alloctracklib::deallocate(pointer); }
+void operator delete[](void * pointer) noexcept { alloctracklib::deallocate(pointer); }
+void operator delete(void * pointer, std::size_t) noexcept { alloctracklib::deallocate(pointer); }
+void operator delete[](void * pointer, std::size_t) noexcept { alloctracklib::deallocate(pointer); }
+void operator delete(void * pointer, const std::nothrow_t &) noexcept { alloctracklib::deallocate(pointer); }
+void operator delete[](void * pointer, const std::nothrow_t &) noexcept { alloctracklib::deallocate(pointer); }
+void operator delete(void * pointer, std::align_val_t) noexcept { alloctracklib::deallocate(pointer); }
+void operator delete[](void * pointer, std::align_val_t) noexcept { alloctracklib::deallocate(pointer); }
+void operator delete(void * pointer, std::size_t, std::align_val_t) noexcept { alloctracklib::deallocate(pointer); }
+void operator delete[](void * pointer, std::size_t, std::align_val_t) noexcept { alloctracklib::deallocate(pointer); }
+void operator delete(void * pointer, std::align_val_t, const std::nothrow_t &) noexcept { alloctracklib::deallocate(pointer); }
+void operator delete[](void * pointer, std::align_val_t, const std::nothrow_t &) noexcept { alloctracklib::deallocate(pointer); }
@@ -0,0 +1,50 @@
+#include "alloctracklib/LayoutReport.hpp"
+
+#include <algorithm>
+#include <iomanip>
+
+
+namespace alloctracklib
+{
+
+std::size_t TypeLayout::unaccountedBytes() const
+{
+    std::size_t used = 0;
+    for(const auto & field : fields_)
+    {
+        used += field.size_;
+    }
+    return size_ - used;
+}
+
+void printLayout(const TypeLayout & layout, std::ostream & out)
+{
+    out << layout.name_ << ": sizeof " << layout.size_ << ", alignof " << layout.alignment_ << "\n";
+
+    auto fields = layout.fields_;
+    std::sort(fields.begin(), fields.end(), [](const FieldLayout & lhs, const FieldLayout & rhs) { return lhs.offset_ < rhs.offset_; });
+
+    std::size_t position = 0;
+    auto printGap = [&out](std::size_t offset, std::size_t size)
+    {
+        out << "  " << std::setw(4) << offset << "  " << std::setw(4) << size << "  <padding or hidden pointer>\n";
+    };
+
+    for(const auto & field : fields)
+    {
+        if(field.offset_ > position)
+        {
+            printGap(position, field.offset_ - position);
+        }
+        out << "  " << std::setw(4) << field.offset_ << "  " << std::setw(4) << field.size_ << "  " << field.name_ << "\n";
+        position = std::max(position, field.offset_ + field.size_);
+    }
+    if(layout.size_ > position)
+    {
+        printGap(position, layout.size_ - position);
+    }
+
+    out << "  " << layout.unaccountedBytes() << " of " << layout.size_ << " bytes are not data members" << std::endl;
+}
+
+} // end namespace alloctracklib
@@ -0,0 +1,103 @@
+#include "MemoryReport.hpp"
+
+#include "alloctracklib/LayoutReport.hpp"
+#include "classiclib/Events.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+
+
+namespace benchapp
+{
+
+namespace
+{
+
+using alloctracklib::fieldLayout;
+using alloctracklib::typeLayout;
+
+const auto s_now = std::chrono::system_clock::time_point{};
+
+// Session and auth events name their identifier differently
+const std::string & idField(const classiclib::SessionEventBase & event) { return event.sessionId_; }
+const std::string & idField(const classiclib::AuthEventBase & event) { return event.userId_; }
+const std::string & idField(const templatecastlib::SessionEventBase & event) { return event.sessionId_; }
+const std::string & idField(const templatecastlib::AuthEventBase & event) { return event.userId_; }
+const std::string & idField(const purecomplib::SessionEventBaseData & data) { return data.sessionId_; }
+const std::string & idField(const purecomplib::AuthEventBaseData & data) { return data.userId_; }
+
+const purecomplib::SessionEventBaseData & baseData(const purecomplib::SessionStartEvent & event) { return event.sessionBaseData_; }
+const purecomplib::SessionEventBaseData & baseData(const purecomplib::SessionEndEvent & event) { return event.sessionBaseData_; }
+const purecomplib::AuthEventBaseData & baseData(const purecomplib::AuthLoginEvent & event) { return event.authBaseData_; }
+const purecomplib::AuthEventBaseData & baseData(const purecomplib::AuthLogoutEvent & event) { return event.authBaseData_; }
+
+template <class T>
+void printClassicLayout(const char * name, const char * idName, std::ostream & out)
+{
+    T event{ 1, s_now, "id", 0 };
+    alloctracklib::printLayout(typeLayout<T>(name,
+    {
+        fieldLayout("type_", event, event.type_),
+        fieldLayout("pid_", event, event.pid_),
+        fieldLayout("timestamp_", event, event.timestamp_),
+        fieldLayout(idName, event, idField(event)),
+        fieldLayout("someSpecificData_", event, event.someSpecificData_),
+    }), out);
+}
+
+// The private members of IEventID cannot be named here and show up as hidden bytes
+template <class T>
+void printTemplateCastLayout(const char * name, const char * idName, std::ostream & out)
+{
+    T event{ 1, s_now, "id", 0 };
+    alloctracklib::printLayout(typeLayout<T>(name,
+    {
+        fieldLayout("type_", event, event.type_),
+        fieldLayout("pid_", event, event.pid_),
+        fieldLayout("timestamp_", event, event.timestamp_),
+        fieldLayout(idName, event, idField(event)),
+        fieldLayout("specificData_", event, event.specificData_),
+    }), out);
+}
+
+// purecomplib events are only ever held inside the top level variant, so measure them there
+template <class Family, class T>
+void printPureCompLayout(const char * name, const char * idName, std::ostream & out)
+{
+    purecomplib::Event variant{ Family{ T{ 1, s_now, "id", 0 } } };
+    const auto & event = std::get<T>(std::get<Family>(variant));
+
+    const auto & base = baseData(event);
+
+    alloctracklib::printLayout(typeLayout<purecomplib::Event>(name,
+    {
+        fieldLayout("eventBaseData_.pid_", variant, base.eventBaseData_.pid_),
+        fieldLayout("eventBaseData_.timestamp_", variant, base.eventBaseData_.timestamp_),
+        fieldLayout(idName, variant, idField(base)),
+        fieldLayout("someSpecificData_", variant, event.someSpecificData_),
+    }), out);
+}
+
+} // end anonymous namespace
+
+void printLayoutReport(std::ostream & out)
+{
+    out << "classiclib\n";
+    printClassicLayout<classiclib::SessionStartEvent>("SessionStartEvent", "sessionId_", out);
+    printClassicLayout<classiclib::SessionEndEvent>("SessionEndEvent", "sessionId_", out);
+    printClassicLayout<classiclib::AuthLoginEvent>("AuthLoginEvent", "userId_", out);
+    printClassicLayout<classiclib::AuthLogoutEvent>("AuthLogoutEvent", "userId_", out);
+
+    out << "\npurecomplib (as stored in purecomplib::Event)\n";
+    printPureCompLayout<purecomplib::SessionEvent, purecomplib::SessionStartEvent>("Event holding SessionStartEvent", "sessionId_", out);
+    printPureCompLayout<purecomplib::SessionEvent, purecomplib::SessionEndEvent>("Event holding SessionEndEvent", "sessionId_", out);
+    printPureCompLayout<purecomplib::AuthEvent, purecomplib::AuthLoginEvent>("Event holding AuthLoginEvent", "userId_", out);
+    printPureCompLayout<purecomplib::AuthEvent, purecomplib::AuthLogoutEvent>("Event holding AuthLogoutEvent", "userId_", out);
+
+    out << "\ntemplatecastlib\n";
+    printTemplateCastLayout<templatecastlib::SessionStartEvent>("SessionStartEvent", "sessionId_", out);
+    printTemplateCastLayout<templatecastlib::SessionEndEvent>("SessionEndEvent", "sessionId_", out);
+    printTemplateCastLayout<templatecastlib::AuthLoginEvent>("AuthLoginEvent", "userId_", out);
+    printTemplateCastLayout<templatecastlib::AuthLogoutEvent>("AuthLogoutEvent", "userId_", out);
+}
+
+} // end namespace benchapp
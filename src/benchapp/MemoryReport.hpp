@@ -0,0 +1,14 @@
+#ifndef BENCHAPP_MEMORYREPORT_HPP
+#define BENCHAPP_MEMORYREPORT_HPP
+
+#include <iostream>
+
+namespace benchapp
+{
+
+// Print sizeof, field offsets and padding for every event type of every library
+void printLayoutReport(std::ostream & out);
+
+} // end namespace benchapp
+
+#endif // BENCHAPP_MEMORYREPORT_HPP
@@ -0,0 +1,196 @@
+#include "PerfCounters.hpp"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <set>
+
+
+namespace benchapp
+{
+
+namespace
+{
+
+bool s_enabled = false;
+
+struct CounterSpec
+{
+    const char * name_;
+    std::uint32_t type_;
+    std::uint64_t config_;
+};
+
+constexpr std::uint64_t cacheConfig(std::uint64_t cache, std::uint64_t op, std::uint64_t result)
+{
+    return cache | (op << 8) | (result << 16);
+}
+
+const CounterSpec s_specs[] =
+{
+    { "instructions",  PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    { "cycles",        PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    { "branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    { "l1d_misses",    PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_L1D,  PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+    { "llc_misses",    PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_LL,   PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+    { "itlb_misses",   PERF_TYPE_HW_CACHE, cacheConfig(PERF_COUNT_HW_CACHE_ITLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS) },
+};
+
+int openCounter(const CounterSpec & spec)
+{
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = spec.type_;
+    attr.config = spec.config_;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;                // Allowed at perf_event_paranoid <= 2 without privileges
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+}
+
+// Tell the user once per counter that it is missing, rather than once per benchmark
+void warnUnavailable(const char * name, int error)
+{
+    static std::mutex mutex;
+    static std::set<std::string> warned;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if(warned.insert(name).second)
+    {
+        std::cerr << "perf counter " << name << " is unavailable (" << std::strerror(error) << "), reporting timings only" << std::endl;
+    }
+}
+
+} // end anonymous namespace
+
+PerfCounters::PerfCounters()
+{
+    if(!s_enabled)
+    {
+        return;
+    }
+
+    for(const auto & spec : s_specs)
+    {
+        int fd = openCounter(spec);
+        if(fd < 0)
+        {
+            warnUnavailable(spec.name_, errno);
+            continue;
+        }
+        m_counters.push_back(Counter{ spec.name_, fd, 0.0 });
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    for(auto & counter : m_counters)
+    {
+        close(counter.fd_);
+    }
+}
+
+void PerfCounters::setEnabled(bool enabled)
+{
+    s_enabled = enabled;
+}
+
+bool PerfCounters::enabled()
+{
+    return s_enabled;
+}
+
+void PerfCounters::parseCommandLine(int & argc, char ** argv)
+{
+    int kept = 1;
+    for(int i = 1; i < argc; ++i)
+    {
+        if(std::strcmp(argv[i], "--perf_counters") == 0 || std::strcmp(argv[i], "--perf_counters=true") == 0)
+        {
+            setEnabled(true);
+            continue;
+        }
+        if(std::strcmp(argv[i], "--perf_counters=false") == 0)
+        {
+            setEnabled(false);
+            continue;
+        }
+        argv[kept++] = argv[i];
+    }
+    argc = kept;
+}
+
+void PerfCounters::start()
+{
+    for(auto & counter : m_counters)
+    {
+        ioctl(counter.fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(counter.fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void PerfCounters::stop()
+{
+    for(auto & counter : m_counters)
+    {
+        ioctl(counter.fd_, PERF_EVENT_IOC_DISABLE, 0);
+    }
+
+    for(auto & counter : m_counters)
+    {
+        // value, time enabled, time running
+        std::uint64_t values[3] = {};
+        if(read(counter.fd_, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) || values[2] == 0)
+        {
+            counter.value_ = 0.0;
+            continue;
+        }
+
+        // Scale up when the kernel had to multiplex the counter with others
+        counter.value_ = static_cast<double>(values[0]) * static_cast<double>(values[1]) / static_cast<double>(values[2]);
+    }
+}
+
+void PerfCounters::report(benchmark::State & state) const
+{
+    for(const auto & counter : m_counters)
+    {
+        state.counters[counter.name_] = benchmark::Counter(counter.value_, benchmark::Counter::kAvgIterations);
+    }
+}
+
+PerfScope::PerfScope(benchmark::State & state)
+    : m_state(state)
+    , m_stopped(false)
+{
+    m_counters.start();
+}
+
+PerfScope::~PerfScope()
+{
+    stop();
+}
+
+void PerfScope::stop()
+{
+    if(m_stopped)
+    {
+        return;
+    }
+
+    m_counters.stop();
+    m_counters.report(m_state);
+    m_stopped = true;
+}
+
+} // end namespace benchapp
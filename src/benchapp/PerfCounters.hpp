@@ -0,0 +1,66 @@
+#ifndef BENCHAPP_PERFCOUNTERS_HPP
+#define BENCHAPP_PERFCOUNTERS_HPP
+
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+namespace benchapp
+{
+
+/* Hardware performance counters read through perf_event_open(2)
+   Collection is off unless enabled from the command line with --perf_counters. Counters the kernel or the
+   hardware does not provide are skipped, so a benchmark falls back to plain timings when none are available. */
+class PerfCounters
+{
+public:
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters & operator=(const PerfCounters &) = delete;
+
+    // Globally turn collection on or off. Must be called before any benchmark runs
+    static void setEnabled(bool enabled);
+    static bool enabled();
+
+    // Remove --perf_counters[=true|false] from the command line, enabling or disabling collection as it says
+    static void parseCommandLine(int & argc, char ** argv);
+
+    void start();
+    void stop();
+
+    // Add the collected values, averaged per iteration, to the benchmark's user counters
+    void report(benchmark::State & state) const;
+
+private:
+    struct Counter
+    {
+        std::string name_;                  // Name reported as the user counter
+        int fd_;                            // perf event file descriptor
+        double value_;                      // Last read value, scaled for multiplexing
+    };
+
+    std::vector<Counter> m_counters;
+};
+
+/* Starts the counters on construction and reports them into the benchmark state when stopped or destroyed
+   Declare immediately before the benchmark loop. */
+class PerfScope
+{
+public:
+    explicit PerfScope(benchmark::State & state);
+    ~PerfScope();
+
+    void stop();
+
+private:
+    benchmark::State & m_state;
+    PerfCounters m_counters;
+    bool m_stopped;
+};
+
+} // end namespace benchapp
+
+#endif // BENCHAPP_PERFCOUNTERS_HPP
@@ -1,11 +1,37 @@
 #include "classiclib/Events.hpp"
 #include "purecomplib/Events.hpp"
 #include "templatecastlib/Events.hpp"
+#include "MemoryReport.hpp"
+#include "PerfCounters.hpp"
+
+#include "alloctracklib/AllocTracker.hpp"
+#include "commonlib/Archive.hpp"
+#include "commonlib/AsyncFileWriter.hpp"
+#include "commonlib/Clock.hpp"
+#include "commonlib/DedupFilter.hpp"
+#include "commonlib/FieldDescriptor.hpp"
+#include "commonlib/Hash.hpp"
+#include "commonlib/Json.hpp"
+#include "commonlib/LogParser.hpp"
+#include "commonlib/MappedFile.hpp"
+#include "commonlib/Pipeline.hpp"
+#include "commonlib/PriorityDispatcher.hpp"
+#include "commonlib/Sampler.hpp"
 
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
 #include <fstream>
+#include <iomanip>
 #include <memory>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <vector>
 
 
 void BM_classic(benchmark::State & state)
@@ -16,6 +42,7 @@ void BM_classic(benchmark::State & state)
         throw std::runtime_error("Failed to open output file");
     }
 
+    benchapp::PerfScope perf(state);
     for (auto _ : state)
     {
         auto sessionStartEvent = std::unique_ptr<classiclib::EventBase>(new classiclib::SessionStartEvent{ 9876, std::chrono::system_clock::now(), "session123", 42 });
@@ -24,7 +51,9 @@ void BM_classic(benchmark::State & state)
         auto authLoginEvent = std::unique_ptr<classiclib::EventBase>(new classiclib::AuthLoginEvent{ 6789, std::chrono::system_clock::now(), "Fred", 42 });
         classiclib::handleEvent(authLoginEvent.get(), out);
     }
+    perf.stop();
 
+    state.SetBytesProcessed(out.tellp());
     out.close();
 }
 BENCHMARK(BM_classic);
@@ -37,6 +66,7 @@ void BM_purecomp(benchmark::State & state)
         throw std::runtime_error("Failed to open output file");
     }
 
+    benchapp::PerfScope perf(state);
     for (auto _ : state)
     {
         auto sessionStartEvent = std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionStartEvent{9876, std::chrono::system_clock::now(), "session123", 42}});
@@ -45,6 +75,7 @@ void BM_purecomp(benchmark::State & state)
         auto authLoginEvent = std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLoginEvent{6789, std::chrono::system_clock::now(), "Fred", 42}});
         purecomplib::handleEvent(authLoginEvent.get(), out);
     }
+    perf.stop();
 
     out.close();
 }
@@ -58,6 +89,7 @@ void BM_templatecast(benchmark::State & state)
         throw std::runtime_error("Failed to open output file");
     }
 
+    benchapp::PerfScope perf(state);
     for (auto _ : state)
     {
         auto sessionStartEvent = std::unique_ptr<templatecastlib::Event>(new templatecastlib::SessionStartEvent{9876, std::chrono::system_clock::now(), "session123", 42});
@@ -66,10 +98,1266 @@ void BM_templatecast(benchmark::State & state)
         auto authLoginEvent = std::unique_ptr<templatecastlib::Event>(new templatecastlib::AuthLoginEvent{6789, std::chrono::system_clock::now(), "Fred", 42});
         templatecastlib::handleEvent(authLoginEvent.get(), out);
     }
+    perf.stop();
 
     out.close();
 }
 BENCHMARK(BM_templatecast);
 
 
-BENCHMARK_MAIN();
+/* Sinks for the handler benchmarks, reset between iterations so that all of them write to memory
+   OstreamSink is the generic path every std::ostream caller takes, the other two are specialized instantiations */
+template <class Sink>
+struct SinkFixture;
+
+template <>
+struct SinkFixture<commonlib::OstreamSink>
+{
+    std::ostringstream stream_;
+    commonlib::OstreamSink sink_{ stream_ };
+    void reset() { stream_.seekp(0); }
+};
+
+template <>
+struct SinkFixture<commonlib::BufferSink>
+{
+    commonlib::BufferSink sink_{ 4096 };
+    void reset() { sink_.clear(); }
+};
+
+template <>
+struct SinkFixture<commonlib::CountingSink>
+{
+    commonlib::CountingSink sink_;
+    void reset() {}
+};
+
+template <class Sink>
+void BM_sink_classic(benchmark::State & state)
+{
+    const auto now = std::chrono::system_clock::now();
+    std::unique_ptr<classiclib::EventBase> events[] =
+    {
+        std::make_unique<classiclib::SessionStartEvent>(9876, now, "session123", 42),
+        std::make_unique<classiclib::SessionEndEvent>(9876, now, "session123", 42),
+        std::make_unique<classiclib::AuthLoginEvent>(6789, now, "Fred", 42),
+        std::make_unique<classiclib::AuthLogoutEvent>(6789, now, "Fred", 42),
+    };
+
+    SinkFixture<Sink> fixture;
+    for (auto _ : state)
+    {
+        fixture.reset();
+        for (const auto & event : events)
+        {
+            classiclib::handleEvent(event.get(), fixture.sink_);
+        }
+        benchmark::DoNotOptimize(fixture.sink_);
+    }
+    state.SetItemsProcessed(state.iterations() * std::size(events));
+}
+BENCHMARK_TEMPLATE(BM_sink_classic, commonlib::OstreamSink);
+BENCHMARK_TEMPLATE(BM_sink_classic, commonlib::BufferSink);
+BENCHMARK_TEMPLATE(BM_sink_classic, commonlib::CountingSink);
+
+template <class Sink>
+void BM_sink_purecomp(benchmark::State & state)
+{
+    const auto now = std::chrono::system_clock::now();
+    std::unique_ptr<purecomplib::Event> events[] =
+    {
+        std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionStartEvent{9876, now, "session123", 42}}),
+        std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionEndEvent{9876, now, "session123", 42}}),
+        std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLoginEvent{6789, now, "Fred", 42}}),
+        std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLogoutEvent{6789, now, "Fred", 42}}),
+    };
+
+    SinkFixture<Sink> fixture;
+    for (auto _ : state)
+    {
+        fixture.reset();
+        for (const auto & event : events)
+        {
+            purecomplib::handleEvent(event.get(), fixture.sink_);
+        }
+        benchmark::DoNotOptimize(fixture.sink_);
+    }
+    state.SetItemsProcessed(state.iterations() * std::size(events));
+}
+BENCHMARK_TEMPLATE(BM_sink_purecomp, commonlib::OstreamSink);
+BENCHMARK_TEMPLATE(BM_sink_purecomp, commonlib::BufferSink);
+BENCHMARK_TEMPLATE(BM_sink_purecomp, commonlib::CountingSink);
+
+template <class Sink>
+void BM_sink_templatecast(benchmark::State & state)
+{
+    const auto now = std::chrono::system_clock::now();
+    std::unique_ptr<templatecastlib::Event> events[] =
+    {
+        std::make_unique<templatecastlib::SessionStartEvent>(9876, now, "session123", 42),
+        std::make_unique<templatecastlib::SessionEndEvent>(9876, now, "session123", 42),
+        std::make_unique<templatecastlib::AuthLoginEvent>(6789, now, "Fred", 42),
+        std::make_unique<templatecastlib::AuthLogoutEvent>(6789, now, "Fred", 42),
+    };
+
+    SinkFixture<Sink> fixture;
+    for (auto _ : state)
+    {
+        fixture.reset();
+        for (const auto & event : events)
+        {
+            templatecastlib::handleEvent(event.get(), fixture.sink_);
+        }
+        benchmark::DoNotOptimize(fixture.sink_);
+    }
+    state.SetItemsProcessed(state.iterations() * std::size(events));
+}
+BENCHMARK_TEMPLATE(BM_sink_templatecast, commonlib::OstreamSink);
+BENCHMARK_TEMPLATE(BM_sink_templatecast, commonlib::BufferSink);
+BENCHMARK_TEMPLATE(BM_sink_templatecast, commonlib::CountingSink);
+
+
+/* The same events formatted by walking each library's field descriptors instead of its hand written handlers
+   Compare with BM_sink_* for speed. For code size compare the handleEvent and formatDescribed symbols:
+   nm -C --size-sort benchapp | grep -E "handleEvent|formatDescribed" */
+template <class Sink>
+void BM_described_classic(benchmark::State & state)
+{
+    const auto now = std::chrono::system_clock::now();
+    std::unique_ptr<classiclib::EventBase> events[] =
+    {
+        std::make_unique<classiclib::SessionStartEvent>(9876, now, "session123", 42),
+        std::make_unique<classiclib::SessionEndEvent>(9876, now, "session123", 42),
+        std::make_unique<classiclib::AuthLoginEvent>(6789, now, "Fred", 42),
+        std::make_unique<classiclib::AuthLogoutEvent>(6789, now, "Fred", 42),
+    };
+
+    SinkFixture<Sink> fixture;
+    for (auto _ : state)
+    {
+        fixture.reset();
+        for (const auto & event : events)
+        {
+            commonlib::formatDescribed(fixture.sink_, classiclib::describe(event.get()));
+        }
+        benchmark::DoNotOptimize(fixture.sink_);
+    }
+    state.SetItemsProcessed(state.iterations() * std::size(events));
+}
+BENCHMARK_TEMPLATE(BM_described_classic, commonlib::BufferSink);
+BENCHMARK_TEMPLATE(BM_described_classic, commonlib::CountingSink);
+
+template <class Sink>
+void BM_described_purecomp(benchmark::State & state)
+{
+    const auto now = std::chrono::system_clock::now();
+    std::unique_ptr<purecomplib::Event> events[] =
+    {
+        std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionStartEvent{9876, now, "session123", 42}}),
+        std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionEndEvent{9876, now, "session123", 42}}),
+        std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLoginEvent{6789, now, "Fred", 42}}),
+        std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLogoutEvent{6789, now, "Fred", 42}}),
+    };
+
+    SinkFixture<Sink> fixture;
+    for (auto _ : state)
+    {
+        fixture.reset();
+        for (const auto & event : events)
+        {
+            commonlib::formatDescribed(fixture.sink_, purecomplib::describe(event.get()));
+        }
+        benchmark::DoNotOptimize(fixture.sink_);
+    }
+    state.SetItemsProcessed(state.iterations() * std::size(events));
+}
+BENCHMARK_TEMPLATE(BM_described_purecomp, commonlib::BufferSink);
+BENCHMARK_TEMPLATE(BM_described_purecomp, commonlib::CountingSink);
+
+template <class Sink>
+void BM_described_templatecast(benchmark::State & state)
+{
+    const auto now = std::chrono::system_clock::now();
+    std::unique_ptr<templatecastlib::Event> events[] =
+    {
+        std::make_unique<templatecastlib::SessionStartEvent>(9876, now, "session123", 42),
+        std::make_unique<templatecastlib::SessionEndEvent>(9876, now, "session123", 42),
+        std::make_unique<templatecastlib::AuthLoginEvent>(6789, now, "Fred", 42),
+        std::make_unique<templatecastlib::AuthLogoutEvent>(6789, now, "Fred", 42),
+    };
+
+    SinkFixture<Sink> fixture;
+    for (auto _ : state)
+    {
+        fixture.reset();
+        for (const auto & event : events)
+        {
+            commonlib::formatDescribed(fixture.sink_, templatecastlib::describe(event.get()));
+        }
+        benchmark::DoNotOptimize(fixture.sink_);
+    }
+    state.SetItemsProcessed(state.iterations() * std::size(events));
+}
+BENCHMARK_TEMPLATE(BM_described_templatecast, commonlib::BufferSink);
+BENCHMARK_TEMPLATE(BM_described_templatecast, commonlib::CountingSink);
+
+// Binary encoding through the same descriptors, reporting encoded bytes per second
+void BM_encode_classic(benchmark::State & state)
+{
+    const auto now = std::chrono::system_clock::now();
+    std::unique_ptr<classiclib::EventBase> events[] =
+    {
+        std::make_unique<classiclib::SessionStartEvent>(9876, now, "session123", 42),
+        std::make_unique<classiclib::SessionEndEvent>(9876, now, "session123", 42),
+        std::make_unique<classiclib::AuthLoginEvent>(6789, now, "Fred", 42),
+        std::make_unique<classiclib::AuthLogoutEvent>(6789, now, "Fred", 42),
+    };
+
+    commonlib::BufferSink sink(4096);
+    for (auto _ : state)
+    {
+        sink.clear();
+        for (const auto & event : events)
+        {
+            commonlib::encodeDescribed(sink, classiclib::describe(event.get()));
+        }
+        benchmark::DoNotOptimize(sink);
+    }
+    state.SetItemsProcessed(state.iterations() * std::size(events));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * sink.size()));
+}
+BENCHMARK(BM_encode_classic);
+
+/* Each library's events as JSON lines, into a preallocated buffer
+   Compare with BM_sink_* for the cost of JSON over the text format; both come out at one line per field or event */
+void BM_json_classic(benchmark::State & state)
+{
+    const auto now = std::chrono::system_clock::now();
+    std::unique_ptr<classiclib::EventBase> events[] =
+    {
+        std::make_unique<classiclib::SessionStartEvent>(9876, now, "session123", 42),
+        std::make_unique<classiclib::SessionEndEvent>(9876, now, "session123", 42),
+        std::make_unique<classiclib::AuthLoginEvent>(6789, now, "Fred", 42),
+        std::make_unique<classiclib::AuthLogoutEvent>(6789, now, "Fred", 42),
+    };
+
+    SinkFixture<commonlib::BufferSink> fixture;
+    for (auto _ : state)
+    {
+        fixture.reset();
+        for (const auto & event : events)
+        {
+            classiclib::handleEventJson(event.get(), fixture.sink_);
+        }
+        benchmark::DoNotOptimize(fixture.sink_);
+    }
+    state.SetItemsProcessed(state.iterations() * std::size(events));
+}
+BENCHMARK(BM_json_classic);
+
+void BM_json_purecomp(benchmark::State & state)
+{
+    const auto now = std::chrono::system_clock::now();
+    std::unique_ptr<purecomplib::Event> events[] =
+    {
+        std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionStartEvent{9876, now, "session123", 42}}),
+        std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionEndEvent{9876, now, "session123", 42}}),
+        std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLoginEvent{6789, now, "Fred", 42}}),
+        std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLogoutEvent{6789, now, "Fred", 42}}),
+    };
+
+    SinkFixture<commonlib::BufferSink> fixture;
+    for (auto _ : state)
+    {
+        fixture.reset();
+        for (const auto & event : events)
+        {
+            purecomplib::handleEventJson(event.get(), fixture.sink_);
+        }
+        benchmark::DoNotOptimize(fixture.sink_);
+    }
+    state.SetItemsProcessed(state.iterations() * std::size(events));
+}
+BENCHMARK(BM_json_purecomp);
+
+void BM_json_templatecast(benchmark::State & state)
+{
+    const auto now = std::chrono::system_clock::now();
+    std::unique_ptr<templatecastlib::Event> events[] =
+    {
+        std::make_unique<templatecastlib::SessionStartEvent>(9876, now, "session123", 42),
+        std::make_unique<templatecastlib::SessionEndEvent>(9876, now, "session123", 42),
+        std::make_unique<templatecastlib::AuthLoginEvent>(6789, now, "Fred", 42),
+        std::make_unique<templatecastlib::AuthLogoutEvent>(6789, now, "Fred", 42),
+    };
+
+    SinkFixture<commonlib::BufferSink> fixture;
+    for (auto _ : state)
+    {
+        fixture.reset();
+        for (const auto & event : events)
+        {
+            templatecastlib::handleEventJson(event.get(), fixture.sink_);
+        }
+        benchmark::DoNotOptimize(fixture.sink_);
+    }
+    state.SetItemsProcessed(state.iterations() * std::size(events));
+}
+BENCHMARK(BM_json_templatecast);
+
+/* String escaping on its own, reporting input bytes per second
+   Arg is the string length. The clean case never leaves the vector scan; the dirty one has a quote every 16 bytes */
+void BM_json_escape(benchmark::State & state, bool dirty)
+{
+    std::string text(static_cast<std::size_t>(state.range(0)), 'x');
+    if (dirty)
+    {
+        for (std::size_t i = 7; i < text.size(); i += 16)
+        {
+            text[i] = '"';
+        }
+    }
+
+    commonlib::BufferSink sink(4 * text.size() + 16);
+    for (auto _ : state)
+    {
+        sink.clear();
+        commonlib::appendJsonString(sink, text);
+        benchmark::DoNotOptimize(sink);
+    }
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+BENCHMARK_CAPTURE(BM_json_escape, clean, false)->Arg(10)->Arg(64)->Arg(1024);
+BENCHMARK_CAPTURE(BM_json_escape, dirty, true)->Arg(10)->Arg(64)->Arg(1024);
+
+
+/* BM_classic's events through an AsyncFileSink, to set against BM_classic's flushed std::ofstream
+   Args are the backend (see AsyncFileWriterOptions::Backend) and whether to ask for O_DIRECT */
+void BM_output_async(benchmark::State & state)
+{
+    commonlib::AsyncFileWriterOptions options;
+    options.backend_ = static_cast<commonlib::AsyncFileWriterOptions::Backend>(state.range(0));
+    options.directIO_ = state.range(1) != 0;
+
+    std::unique_ptr<commonlib::AsyncFileWriter> writer;
+    try
+    {
+        writer = commonlib::openAsyncFileWriter("temp.txt", options);
+    }
+    catch (const std::system_error & e)
+    {
+        // io_uring in particular is refused by some sandboxes and container seccomp profiles
+        state.SkipWithError(e.what());
+        return;
+    }
+    state.SetLabel(std::string(writer->backendName()) + (writer->directIO() ? " O_DIRECT" : ""));
+
+    // Every iteration writes the same number of bytes, so count one up front
+    commonlib::CountingSink counter;
+    classiclib::handleEvent(std::make_unique<classiclib::SessionStartEvent>(9876, std::chrono::system_clock::now(), "session123", 42).get(), counter);
+    classiclib::handleEvent(std::make_unique<classiclib::AuthLoginEvent>(6789, std::chrono::system_clock::now(), "Fred", 42).get(), counter);
+
+    commonlib::AsyncFileSink sink(*writer);
+    for (auto _ : state)
+    {
+        auto sessionStartEvent = std::unique_ptr<classiclib::EventBase>(new classiclib::SessionStartEvent{ 9876, std::chrono::system_clock::now(), "session123", 42 });
+        classiclib::handleEvent(sessionStartEvent.get(), sink);
+
+        auto authLoginEvent = std::unique_ptr<classiclib::EventBase>(new classiclib::AuthLoginEvent{ 6789, std::chrono::system_clock::now(), "Fred", 42 });
+        classiclib::handleEvent(authLoginEvent.get(), sink);
+    }
+    sink.close();
+
+    state.SetBytesProcessed(static_cast<std::int64_t>(counter.bytes() * state.iterations()));
+}
+BENCHMARK(BM_output_async)
+    ->Args({ commonlib::AsyncFileWriterOptions::IO_URING, 0 })
+    ->Args({ commonlib::AsyncFileWriterOptions::IO_URING, 1 })
+    ->Args({ commonlib::AsyncFileWriterOptions::PWRITEV, 0 })
+    ->Args({ commonlib::AsyncFileWriterOptions::PWRITEV, 1 });
+
+
+/* Admit state.range(0) distinct fingerprints into a filter sized for them, at a 1% false positive target
+   Reports the filter's memory and the false positive rate actually seen */
+void BM_dedup_admit(benchmark::State & state)
+{
+    const auto events = static_cast<std::uint64_t>(state.range(0));
+
+    commonlib::DedupFilterOptions options;
+    options.expectedEventsPerWindow_ = events;
+    options.falsePositiveRate_ = 0.01;
+    commonlib::DedupFilter filter(options);
+
+    const auto now = std::chrono::steady_clock::now();
+    std::uint64_t next = 0;
+    std::uint64_t rejected = 0;
+    for (auto _ : state)
+    {
+        for (std::uint64_t i = 0; i < events; ++i)
+        {
+            rejected += filter.admit(commonlib::mixHash(next++), now) ? 0 : 1;
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(next));
+    state.counters["memory_bytes"] = static_cast<double>(filter.memoryBytes());
+    state.counters["bytes_per_event"] = static_cast<double>(filter.memoryBytes()) / static_cast<double>(events);
+    state.counters["false_positive_rate"] = static_cast<double>(rejected) / static_cast<double>(next);
+}
+BENCHMARK(BM_dedup_admit)->Arg(10000000)->Arg(20000000)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// Cost of the fingerprint each library computes in front of the filter
+void BM_dedup_fingerprint_classic(benchmark::State & state)
+{
+    auto event = std::make_unique<classiclib::SessionStartEvent>(9876, std::chrono::system_clock::now(), "session123", 42);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(classiclib::fingerprint(event.get()));
+    }
+}
+BENCHMARK(BM_dedup_fingerprint_classic);
+
+void BM_dedup_fingerprint_purecomp(benchmark::State & state)
+{
+    auto event = std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionStartEvent{9876, std::chrono::system_clock::now(), "session123", 42}});
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(purecomplib::fingerprint(event.get()));
+    }
+}
+BENCHMARK(BM_dedup_fingerprint_purecomp);
+
+void BM_dedup_fingerprint_templatecast(benchmark::State & state)
+{
+    auto event = std::make_unique<templatecastlib::SessionStartEvent>(9876, std::chrono::system_clock::now(), "session123", 42);
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(templatecastlib::fingerprint(event.get()));
+    }
+}
+BENCHMARK(BM_dedup_fingerprint_templatecast);
+
+
+/* A login storm: every millisecond 90 AUTH_LOGIN, 5 SESSION_START and 5 SESSION_END events arrive but only 50 can be
+   handled, for one simulated second, after which the backlog drains. Arg 0 dispatches in arrival order, as calling
+   handleEvent directly does; Arg 1 serves sessions first and caps and sheds logins. Reports each session type's p99
+   wait in simulated milliseconds and how many events of each type were dropped. */
+void BM_priority_overload(benchmark::State & state)
+{
+    using Dispatcher = commonlib::PriorityDispatcher<const classiclib::EventBase *>;
+    using commonlib::EventKind;
+
+    constexpr int StormTicks = 1000;
+    constexpr std::size_t BudgetPerTick = 50;
+    const std::pair<EventKind, int> arrivals[] = { { EventKind::AUTH_LOGIN, 90 }, { EventKind::SESSION_START, 5 }, { EventKind::SESSION_END, 5 } };
+
+    std::array<commonlib::KindPolicy, commonlib::EventKindCount> policies{};
+    if (state.range(0) == 1)
+    {
+        for (auto & policy : policies)
+        {
+            policy.priority_ = 1;
+            policy.ratePerSecond_ = 30000;
+            policy.burst_ = 100;
+            policy.highWatermark_ = 2000;
+            policy.shed_ = commonlib::KindPolicy::DROP_OLDEST;
+        }
+        policies[commonlib::kindIndex(EventKind::SESSION_START)] = commonlib::KindPolicy{};
+        policies[commonlib::kindIndex(EventKind::SESSION_END)] = commonlib::KindPolicy{};
+    }
+
+    const classiclib::SessionStartEvent sessionStart{ 9876, std::chrono::system_clock::now(), "session123", 42 };
+    const classiclib::SessionEndEvent sessionEnd{ 9876, std::chrono::system_clock::now(), "session123", 42 };
+    const classiclib::AuthLoginEvent authLogin{ 6789, std::chrono::system_clock::now(), "Fred", 42 };
+    auto eventOf = [&](EventKind kind) -> const classiclib::EventBase *
+    {
+        switch (kind)
+        {
+            case EventKind::SESSION_START: return &sessionStart;
+            case EventKind::SESSION_END:   return &sessionEnd;
+            default:                       return &authLogin;
+        }
+    };
+
+    commonlib::BufferSink sink;
+    std::array<std::vector<double>, commonlib::EventKindCount> waits;
+    std::array<std::uint64_t, commonlib::EventKindCount> dropped{};
+    std::uint64_t handled = 0;
+
+    for (auto _ : state)
+    {
+        // Simulated time, so the result does not depend on how fast this machine formats events
+        auto now = Dispatcher::Clock::time_point{} + std::chrono::hours(1);
+        Dispatcher dispatcher(policies, now);
+        for (auto & kindWaits : waits)
+        {
+            kindWaits.clear();
+        }
+
+        auto handler = [&](EventKind kind, const classiclib::EventBase * event, Dispatcher::Clock::time_point enqueuedAt)
+        {
+            sink.clear();
+            classiclib::handleEvent(event, sink);
+            waits[commonlib::kindIndex(kind)].push_back(std::chrono::duration<double, std::milli>(now - enqueuedAt).count());
+        };
+
+        for (int tick = 0; tick < StormTicks || dispatcher.queued() > 0; ++tick)
+        {
+            if (tick < StormTicks)
+            {
+                // Interleave the arrivals across the tick as they would come in
+                for (int i = 0; i < 90; ++i)
+                {
+                    for (const auto & [kind, count] : arrivals)
+                    {
+                        if (i * count / 90 != (i + 1) * count / 90)
+                        {
+                            dispatcher.submit(kind, eventOf(kind), now);
+                        }
+                    }
+                }
+            }
+            handled += dispatcher.dispatch(BudgetPerTick, handler, now);
+            now += std::chrono::milliseconds(1);
+        }
+
+        for (std::size_t kind = 0; kind < commonlib::EventKindCount; ++kind)
+        {
+            dropped[kind] = dispatcher.stats(static_cast<EventKind>(kind)).dropped_;
+        }
+    }
+
+    auto p99 = [](std::vector<double> & values)
+    {
+        if (values.empty())
+        {
+            return 0.0;
+        }
+        auto nth = values.begin() + static_cast<std::ptrdiff_t>(values.size() * 99 / 100);
+        std::nth_element(values.begin(), nth, values.end());
+        return *nth;
+    };
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(handled));
+    state.counters["session_start_p99_ms"] = p99(waits[commonlib::kindIndex(EventKind::SESSION_START)]);
+    state.counters["session_end_p99_ms"] = p99(waits[commonlib::kindIndex(EventKind::SESSION_END)]);
+    state.counters["auth_login_p99_ms"] = p99(waits[commonlib::kindIndex(EventKind::AUTH_LOGIN)]);
+    state.counters["session_end_dropped"] = static_cast<double>(dropped[commonlib::kindIndex(EventKind::SESSION_END)]);
+    state.counters["auth_login_dropped"] = static_cast<double>(dropped[commonlib::kindIndex(EventKind::AUTH_LOGIN)]);
+}
+BENCHMARK(BM_priority_overload)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+
+
+// Cost of the sampling decision alone, on keys hashed up front
+void BM_sample_decision(benchmark::State & state)
+{
+    std::array<commonlib::SamplingPolicy, commonlib::EventKindCount> policies{};
+    policies[commonlib::kindIndex(commonlib::EventKind::AUTH_LOGIN)].mode_ = commonlib::SamplingPolicy::FIXED;
+    policies[commonlib::kindIndex(commonlib::EventKind::AUTH_LOGIN)].rate_ = 0.1;
+    commonlib::Sampler sampler(policies);
+
+    std::vector<std::uint64_t> keys(1024);
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        keys[i] = commonlib::hashBytes("user" + std::to_string(i));
+    }
+
+    std::size_t next = 0;
+    for (auto _ : state)
+    {
+        auto decision = sampler.sample(commonlib::EventKind::AUTH_LOGIN, keys[next++ & 1023]);
+        benchmark::DoNotOptimize(decision);
+    }
+}
+BENCHMARK(BM_sample_decision);
+
+/* Logins from 100000 users formatted into memory, keeping all of them (Arg 0) or adaptively about 100000 a second
+   (Arg 1), whatever fraction of the offered rate that is; kept_fraction reports it. The per event cost includes hashing
+   the user id and the sampling decision; kept events carry their weight */
+void BM_sample_classic(benchmark::State & state)
+{
+    std::vector<std::unique_ptr<classiclib::EventBase>> events;
+    for (int i = 0; i < 100000; ++i)
+    {
+        events.emplace_back(new classiclib::AuthLoginEvent{ 6789, std::chrono::system_clock::now(), "user" + std::to_string(i), 42 });
+    }
+
+    std::array<commonlib::SamplingPolicy, commonlib::EventKindCount> policies{};
+    auto & loginPolicy = policies[commonlib::kindIndex(commonlib::EventKind::AUTH_LOGIN)];
+    if (state.range(0) == 1)
+    {
+        loginPolicy.mode_ = commonlib::SamplingPolicy::ADAPTIVE;
+        loginPolicy.targetPerSecond_ = 100000;
+    }
+    commonlib::Sampler sampler(policies);
+
+    commonlib::BufferSink sink(1 << 20);
+    std::size_t next = 0;
+    double weighted = 0.0;
+
+    benchapp::PerfScope perf(state);
+    for (auto _ : state)
+    {
+        const auto * event = events[next++ % events.size()].get();
+        auto decision = sampler.sample(classiclib::eventKind(event), classiclib::samplingKey(event));
+        if (decision.keep_)
+        {
+            if (sink.size() > (1 << 19))
+            {
+                sink.clear();
+            }
+            classiclib::handleEvent(event, sink);
+            commonlib::appendSampleWeight(sink, decision.weight_);
+            weighted += decision.weight_;
+        }
+        if ((next & 1023) == 0)
+        {
+            sampler.update();
+        }
+    }
+    perf.stop();
+
+    const auto login = commonlib::EventKind::AUTH_LOGIN;
+    state.SetItemsProcessed(state.iterations());
+    state.counters["kept_fraction"] = static_cast<double>(sampler.kept(login)) / static_cast<double>(sampler.offered(login));
+    state.counters["weighted_count_error"] = weighted / static_cast<double>(sampler.offered(login)) - 1.0;
+}
+BENCHMARK(BM_sample_classic)->Arg(0)->Arg(1);
+
+
+/* About 16 MB of handler output from all three libraries, written once to temp_log.txt for the parsing benchmarks
+   Timestamps step by a second per event so that the parser's time zone cache sees realistic turnover */
+const std::string & parseBenchmarkLog()
+{
+    static const std::string path = []
+    {
+        const std::string logPath = "temp_log.txt";
+        std::ofstream out(logPath, std::ios::binary | std::ios::trunc);
+        commonlib::BufferSink sink(1 << 20);
+        auto timestamp = std::chrono::system_clock::now();
+        for (int i = 0; sink.size() + static_cast<std::size_t>(out.tellp()) < (16 << 20); ++i)
+        {
+            timestamp += std::chrono::seconds(1);
+            const std::string id = "session" + std::to_string(i % 10007);
+            switch (i % 3)
+            {
+                case 0: classiclib::handleEvent(std::make_unique<classiclib::SessionStartEvent>(9876, timestamp, id, i).get(), sink); break;
+                case 1: purecomplib::handleEvent(std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLoginEvent{6789, timestamp, id, i}}).get(), sink); break;
+                default: templatecastlib::handleEvent(std::make_unique<templatecastlib::SessionEndEvent>(9876, timestamp, id, i).get(), sink); break;
+            }
+            if (sink.size() > (1 << 19))
+            {
+                out << sink.buffer();
+                sink.clear();
+            }
+        }
+        out << sink.buffer();
+        return logPath;
+    }();
+    return path;
+}
+
+// Parse the whole mapped log with each line scan, Arg being a commonlib::LogParser::Scan
+void BM_parse_log(benchmark::State & state)
+{
+    const auto scan = static_cast<commonlib::LogParser::Scan>(state.range(0));
+    if (!commonlib::LogParser::supported(scan))
+    {
+        state.SkipWithError("Scan not supported on this CPU");
+        return;
+    }
+
+    commonlib::MappedFile file(parseBenchmarkLog());
+    std::size_t events = 0;
+    for (auto _ : state)
+    {
+        commonlib::LogParser parser(file.text(), scan);
+        commonlib::ParsedEvent event;
+        while (parser.next(event))
+        {
+            benchmark::DoNotOptimize(event);
+            ++events;
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(events));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * file.text().size()));
+}
+BENCHMARK(BM_parse_log)
+    ->Arg(commonlib::LogParser::AVX2)
+    ->Arg(commonlib::LogParser::SSE2)
+    ->Arg(commonlib::LogParser::SCALAR)
+    ->Unit(benchmark::kMillisecond);
+
+// Parse and rebuild every event as a classiclib event, the cost of re-ingesting into a library
+void BM_parse_log_rebuild(benchmark::State & state)
+{
+    commonlib::MappedFile file(parseBenchmarkLog());
+    std::size_t events = 0;
+    for (auto _ : state)
+    {
+        commonlib::LogParser parser(file.text());
+        commonlib::ParsedEvent event;
+        while (parser.next(event))
+        {
+            auto rebuilt = classiclib::makeEvent(event);
+            benchmark::DoNotOptimize(rebuilt);
+            ++events;
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(events));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * file.text().size()));
+}
+BENCHMARK(BM_parse_log_rebuild)->Unit(benchmark::kMillisecond);
+
+// The line by line iostream approach, with std::get_time for the timestamp, for comparison
+void BM_parse_log_getline(benchmark::State & state)
+{
+    const auto & path = parseBenchmarkLog();
+    std::size_t bytes = 0;
+    std::size_t events = 0;
+    for (auto _ : state)
+    {
+        std::ifstream in(path);
+        std::string line;
+        while (std::getline(in, line))
+        {
+            bytes += line.size() + 1;
+            if (line.compare(0, 13, "Timestamp is ") == 0)
+            {
+                std::istringstream stream(line.substr(13));
+                std::tm tm = {};
+                stream >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+                tm.tm_isdst = -1;
+                benchmark::DoNotOptimize(std::mktime(&tm));
+            }
+            else if (auto colon = line.rfind(": "); colon != std::string::npos)
+            {
+                benchmark::DoNotOptimize(std::stoi(line.substr(colon + 2)));
+                ++events;
+            }
+            else if (line.compare(0, 7, "PID is ") == 0)
+            {
+                benchmark::DoNotOptimize(std::stoi(line.substr(7)));
+            }
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(events));
+    state.SetBytesProcessed(static_cast<std::int64_t>(bytes));
+}
+BENCHMARK(BM_parse_log_getline)->Unit(benchmark::kMillisecond);
+
+// The parse benchmark's log converted to an archive, in memory
+const std::string & archiveBenchmarkData()
+{
+    static const std::string archive = []
+    {
+        commonlib::MappedFile file(parseBenchmarkLog());
+        commonlib::LogParser parser(file.text());
+        commonlib::ArchiveWriter writer;
+        commonlib::ParsedEvent event;
+        while (parser.next(event))
+        {
+            writer.append(event);
+        }
+        writer.finish();
+        return writer.data();
+    }();
+    return archive;
+}
+
+/* Archive the parse benchmark's events, already parsed, reporting the size against the text log and against
+   encodeDescribed's row by row binary records */
+void BM_archive_encode(benchmark::State & state)
+{
+    commonlib::MappedFile file(parseBenchmarkLog());
+    std::vector<commonlib::ParsedEvent> events;
+    commonlib::LogParser parser(file.text());
+    commonlib::ParsedEvent event;
+    std::size_t binaryBytes = 0;
+    while (parser.next(event))
+    {
+        events.push_back(event);
+        // The same size for any library: kind, pid, timestamp, id length and id, specific data
+        binaryBytes += 1 + 2 + 8 + 4 + event.id_.size() + 4;
+    }
+
+    std::size_t archiveBytes = 0;
+    for (auto _ : state)
+    {
+        commonlib::ArchiveWriter writer;
+        for (const auto & parsed : events)
+        {
+            writer.append(parsed);
+        }
+        writer.finish();
+        archiveBytes = writer.data().size();
+        benchmark::DoNotOptimize(writer.data().data());
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * events.size()));
+    state.counters["bytes_per_event"] = static_cast<double>(archiveBytes) / static_cast<double>(events.size());
+    state.counters["ratio_text"] = static_cast<double>(file.text().size()) / static_cast<double>(archiveBytes);
+    state.counters["ratio_binary"] = static_cast<double>(binaryBytes) / static_cast<double>(archiveBytes);
+}
+BENCHMARK(BM_archive_encode)->Unit(benchmark::kMillisecond);
+
+// Decode the whole archive with each unpack, Arg being a commonlib::ArchiveReader::Unpack
+void BM_archive_decode(benchmark::State & state)
+{
+    const auto unpack = static_cast<commonlib::ArchiveReader::Unpack>(state.range(0));
+    if (!commonlib::ArchiveReader::supported(unpack))
+    {
+        state.SkipWithError("Unpack not supported on this CPU");
+        return;
+    }
+
+    const auto & archive = archiveBenchmarkData();
+    std::vector<commonlib::ParsedEvent> events;
+    std::size_t decoded = 0;
+    for (auto _ : state)
+    {
+        commonlib::ArchiveReader reader(archive, unpack);
+        while (reader.nextBlock(events))
+        {
+            benchmark::DoNotOptimize(events.data());
+            decoded += events.size();
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(decoded));
+    state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations() * archive.size()));
+}
+BENCHMARK(BM_archive_decode)
+    ->Arg(commonlib::ArchiveReader::AVX2)
+    ->Arg(commonlib::ArchiveReader::SCALAR)
+    ->Unit(benchmark::kMillisecond);
+
+// Decode and rebuild every event as a classiclib event, to set against BM_parse_log_rebuild
+void BM_archive_rebuild(benchmark::State & state)
+{
+    const auto & archive = archiveBenchmarkData();
+    std::vector<commonlib::ParsedEvent> events;
+    std::size_t decoded = 0;
+    for (auto _ : state)
+    {
+        commonlib::ArchiveReader reader(archive);
+        while (reader.nextBlock(events))
+        {
+            for (const auto & event : events)
+            {
+                auto rebuilt = classiclib::makeEvent(event);
+                benchmark::DoNotOptimize(rebuilt);
+            }
+            decoded += events.size();
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(decoded));
+}
+BENCHMARK(BM_archive_rebuild)->Unit(benchmark::kMillisecond);
+
+
+/* A batch of 4096 classiclib events of all types, random pids from 0 to 9999 and timestamps in order over 100 seconds,
+   for the pipeline benchmarks */
+std::vector<std::unique_ptr<classiclib::EventBase>> pipelineBatch(std::chrono::system_clock::time_point start)
+{
+    std::vector<std::unique_ptr<classiclib::EventBase>> events;
+    for (int i = 0; i < 4096; ++i)
+    {
+        const auto pid = static_cast<short>(commonlib::mixHash(static_cast<std::uint64_t>(i)) % 10000);
+        const auto timestamp = start + std::chrono::milliseconds(i * 100000 / 4096);
+        const std::string id = "id" + std::to_string(i);
+        switch (i % 4)
+        {
+            case 0: events.push_back(std::make_unique<classiclib::SessionStartEvent>(pid, timestamp, id, i)); break;
+            case 1: events.push_back(std::make_unique<classiclib::SessionEndEvent>(pid, timestamp, id, i)); break;
+            case 2: events.push_back(std::make_unique<classiclib::AuthLoginEvent>(pid, timestamp, id, i)); break;
+            default: events.push_back(std::make_unique<classiclib::AuthLogoutEvent>(pid, timestamp, id, i)); break;
+        }
+    }
+    return events;
+}
+
+/* Filter on type and pid, then format. Arg 0 is the composed pipeline, 1 the same written as one loop by hand, and
+   2 the way steps are chained today, each copying the surviving pointers into a new vector */
+void BM_pipeline_3stage(benchmark::State & state)
+{
+    using commonlib::EventKind;
+    const auto events = pipelineBatch(std::chrono::system_clock::now());
+    const auto isWanted = commonlib::kindIn({ EventKind::SESSION_END, EventKind::AUTH_LOGOUT });
+    const auto isLowPid = commonlib::pidIn(0, 4999);
+
+    commonlib::CountingSink sink;
+    auto pipeline = commonlib::filter(isWanted)
+                  | commonlib::filter(isLowPid)
+                  | commonlib::dispatch([&sink](const auto & event) { classiclib::handleEvent(event.get(), sink); });
+
+    std::size_t dispatched = 0;
+    for (auto _ : state)
+    {
+        if (state.range(0) == 0)
+        {
+            dispatched += pipeline.run(events);
+        }
+        else if (state.range(0) == 1)
+        {
+            for (const auto & event : events)
+            {
+                if (isWanted(event) && isLowPid(event))
+                {
+                    classiclib::handleEvent(event.get(), sink);
+                    ++dispatched;
+                }
+            }
+        }
+        else
+        {
+            std::vector<const classiclib::EventBase *> wanted;
+            for (const auto & event : events)
+            {
+                if (isWanted(event))
+                {
+                    wanted.push_back(event.get());
+                }
+            }
+            std::vector<const classiclib::EventBase *> lowPid;
+            for (const auto * event : wanted)
+            {
+                if (isLowPid(event))
+                {
+                    lowPid.push_back(event);
+                }
+            }
+            for (const auto * event : lowPid)
+            {
+                classiclib::handleEvent(event, sink);
+                ++dispatched;
+            }
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * events.size()));
+    state.counters["dispatched_per_batch"] = static_cast<double>(dispatched) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_pipeline_3stage)->Arg(0)->Arg(1)->Arg(2);
+
+/* Filter on type, pid and time, enrich with the sampling key, sample on it, then format with the weight
+   Args as for BM_pipeline_3stage */
+void BM_pipeline_6stage(benchmark::State & state)
+{
+    using commonlib::EventKind;
+    const auto start = std::chrono::system_clock::now();
+    const auto events = pipelineBatch(start);
+    const auto isWanted = commonlib::kindIn({ EventKind::SESSION_END, EventKind::AUTH_LOGIN, EventKind::AUTH_LOGOUT });
+    const auto isLowPid = commonlib::pidIn(0, 7999);
+    const auto isRecent = commonlib::timeIn(start + std::chrono::seconds(10), start + std::chrono::seconds(90));
+
+    struct Keyed
+    {
+        const classiclib::EventBase * event_;
+        std::uint64_t key_;
+    };
+    auto addKey = [](const auto & event) { return Keyed{ std::to_address(event), classiclib::samplingKey(std::to_address(event)) }; };
+    auto isSampled = [](const Keyed & keyed) { return (keyed.key_ >> 62) != 0; };     // Keep three quarters, weight 4/3
+    constexpr double Weight = 4.0 / 3.0;
+
+    commonlib::CountingSink sink;
+    auto format = [&sink, Weight](const Keyed & keyed)
+    {
+        classiclib::handleEvent(keyed.event_, sink);
+        commonlib::appendSampleWeight(sink, Weight);
+    };
+
+    auto pipeline = commonlib::filter(isWanted)
+                  | commonlib::filter(isLowPid)
+                  | commonlib::filter(isRecent)
+                  | commonlib::enrich(addKey)
+                  | commonlib::filter(isSampled)
+                  | commonlib::dispatch(format);
+
+    std::size_t dispatched = 0;
+    for (auto _ : state)
+    {
+        if (state.range(0) == 0)
+        {
+            dispatched += pipeline.run(events);
+        }
+        else if (state.range(0) == 1)
+        {
+            for (const auto & event : events)
+            {
+                if (!isWanted(event) || !isLowPid(event) || !isRecent(event))
+                {
+                    continue;
+                }
+                Keyed keyed = addKey(event);
+                if (isSampled(keyed))
+                {
+                    format(keyed);
+                    ++dispatched;
+                }
+            }
+        }
+        else
+        {
+            auto keep = [](const auto & from, auto predicate)
+            {
+                std::vector<const classiclib::EventBase *> to;
+                for (const auto & event : from)
+                {
+                    if (predicate(event))
+                    {
+                        to.push_back(std::to_address(event));
+                    }
+                }
+                return to;
+            };
+            auto recent = keep(keep(keep(events, isWanted), isLowPid), isRecent);
+            std::vector<Keyed> keyed;
+            for (const auto * event : recent)
+            {
+                keyed.push_back(addKey(event));
+            }
+            std::vector<Keyed> sampled;
+            for (const auto & item : keyed)
+            {
+                if (isSampled(item))
+                {
+                    sampled.push_back(item);
+                }
+            }
+            for (const auto & item : sampled)
+            {
+                format(item);
+                ++dispatched;
+            }
+        }
+    }
+
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * events.size()));
+    state.counters["dispatched_per_batch"] = static_cast<double>(dispatched) / static_cast<double>(state.iterations());
+}
+BENCHMARK(BM_pipeline_6stage)->Arg(0)->Arg(1)->Arg(2);
+
+
+// Cost of one stamp from each clock
+template <class Clock>
+void BM_clock_now(benchmark::State & state)
+{
+    if constexpr (std::is_same_v<Clock, commonlib::TscClock>)
+    {
+        if (!commonlib::TscClock::supported())
+        {
+            state.SkipWithError("No invariant TSC");
+            return;
+        }
+    }
+
+    Clock clock;
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(clock.now());
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_clock_now, commonlib::SystemClock);
+BENCHMARK_TEMPLATE(BM_clock_now, commonlib::TscClock);
+BENCHMARK_TEMPLATE(BM_clock_now, commonlib::CoarseClock);
+
+/* Each clock against system_clock, sampled about every 100us for 2 seconds of stamping
+   Reports the mean and largest distance in microseconds, and any stamp earlier than the one before it. The
+   system_clock row measures only the two reads being apart */
+template <class Clock>
+void BM_clock_drift(benchmark::State & state)
+{
+    if constexpr (std::is_same_v<Clock, commonlib::TscClock>)
+    {
+        if (!commonlib::TscClock::supported())
+        {
+            state.SkipWithError("No invariant TSC");
+            return;
+        }
+    }
+
+    Clock clock;
+    double total = 0.0;
+    double largest = 0.0;
+    std::size_t samples = 0;
+    std::size_t backwards = 0;
+    for (auto _ : state)
+    {
+        auto previous = clock.now();
+        const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+        for (auto next = std::chrono::steady_clock::now(); next < end; next = std::chrono::steady_clock::now())
+        {
+            const auto before = std::chrono::system_clock::now();
+            const auto stamp = clock.now();
+            const auto after = std::chrono::system_clock::now();
+            const auto reference = before + (after - before) / 2;
+
+            const double distance = std::abs(std::chrono::duration<double, std::micro>(stamp - reference).count());
+            total += distance;
+            largest = std::max(largest, distance);
+            backwards += stamp < previous ? 1 : 0;
+            previous = stamp;
+            ++samples;
+
+            // Keep stamping between samples, as a producer would
+            while (std::chrono::steady_clock::now() < next + std::chrono::microseconds(100))
+            {
+                benchmark::DoNotOptimize(clock.now());
+            }
+        }
+    }
+
+    state.counters["mean_us"] = total / static_cast<double>(samples);
+    state.counters["max_us"] = largest;
+    state.counters["backwards"] = static_cast<double>(backwards);
+}
+BENCHMARK_TEMPLATE(BM_clock_drift, commonlib::SystemClock)->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_clock_drift, commonlib::TscClock)->Iterations(1)->Unit(benchmark::kMillisecond);
+BENCHMARK_TEMPLATE(BM_clock_drift, commonlib::CoarseClock)->Iterations(1)->Unit(benchmark::kMillisecond);
+
+// Making and formatting a classiclib event stamped from each clock, the share of the stamp in a whole event
+template <class Clock>
+void BM_clock_stamp_classic(benchmark::State & state)
+{
+    if constexpr (std::is_same_v<Clock, commonlib::TscClock>)
+    {
+        if (!commonlib::TscClock::supported())
+        {
+            state.SkipWithError("No invariant TSC");
+            return;
+        }
+    }
+
+    Clock clock;
+    SinkFixture<commonlib::BufferSink> fixture;
+    for (auto _ : state)
+    {
+        fixture.reset();
+        auto event = std::make_unique<classiclib::AuthLoginEvent>(6789, clock.now(), "Fred", 42);
+        classiclib::handleEvent(event.get(), fixture.sink_);
+        benchmark::DoNotOptimize(fixture.sink_);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK_TEMPLATE(BM_clock_stamp_classic, commonlib::SystemClock);
+BENCHMARK_TEMPLATE(BM_clock_stamp_classic, commonlib::TscClock);
+BENCHMARK_TEMPLATE(BM_clock_stamp_classic, commonlib::CoarseClock);
+
+
+// Number of events held live at once by the allocation benchmarks
+constexpr int s_allocBatchSize = 1024;
+
+// Report what each event really costs on the heap, for ids of state.range(0) characters
+void reportAllocations(benchmark::State & state, const alloctracklib::AllocStats & stats)
+{
+    double events = static_cast<double>(state.iterations()) * s_allocBatchSize;
+    state.counters["allocs_per_event"] = static_cast<double>(stats.allocations_) / events;
+    state.counters["bytes_per_event"] = static_cast<double>(stats.bytesAllocated_) / events;
+    state.counters["peak_live_bytes_per_event"] = static_cast<double>(stats.peakLiveBytes_) / s_allocBatchSize;
+}
+
+void BM_alloc_classic(benchmark::State & state)
+{
+    const std::string id(state.range(0), 'x');
+    std::vector<std::unique_ptr<classiclib::EventBase>> events;
+
+    alloctracklib::AllocScope scope;
+    for (auto _ : state)
+    {
+        events.reserve(s_allocBatchSize);
+        for (int i = 0; i < s_allocBatchSize; i += 4)
+        {
+            events.emplace_back(new classiclib::SessionStartEvent{ 9876, std::chrono::system_clock::now(), id, i });
+            events.emplace_back(new classiclib::SessionEndEvent{ 9876, std::chrono::system_clock::now(), id, i });
+            events.emplace_back(new classiclib::AuthLoginEvent{ 6789, std::chrono::system_clock::now(), id, i });
+            events.emplace_back(new classiclib::AuthLogoutEvent{ 6789, std::chrono::system_clock::now(), id, i });
+        }
+        benchmark::DoNotOptimize(events.data());
+        events.clear();
+        events.shrink_to_fit();
+    }
+    reportAllocations(state, scope.stats());
+}
+BENCHMARK(BM_alloc_classic)->Arg(8)->Arg(32);
+
+void BM_alloc_purecomp(benchmark::State & state)
+{
+    const std::string id(state.range(0), 'x');
+    std::vector<std::unique_ptr<purecomplib::Event>> events;
+
+    alloctracklib::AllocScope scope;
+    for (auto _ : state)
+    {
+        events.reserve(s_allocBatchSize);
+        for (int i = 0; i < s_allocBatchSize; i += 4)
+        {
+            events.push_back(std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionStartEvent{9876, std::chrono::system_clock::now(), id, i}}));
+            events.push_back(std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionEndEvent{9876, std::chrono::system_clock::now(), id, i}}));
+            events.push_back(std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLoginEvent{6789, std::chrono::system_clock::now(), id, i}}));
+            events.push_back(std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLogoutEvent{6789, std::chrono::system_clock::now(), id, i}}));
+        }
+        benchmark::DoNotOptimize(events.data());
+        events.clear();
+        events.shrink_to_fit();
+    }
+    reportAllocations(state, scope.stats());
+}
+BENCHMARK(BM_alloc_purecomp)->Arg(8)->Arg(32);
+
+void BM_alloc_templatecast(benchmark::State & state)
+{
+    const std::string id(state.range(0), 'x');
+    std::vector<std::unique_ptr<templatecastlib::Event>> events;
+
+    alloctracklib::AllocScope scope;
+    for (auto _ : state)
+    {
+        events.reserve(s_allocBatchSize);
+        for (int i = 0; i < s_allocBatchSize; i += 4)
+        {
+            events.emplace_back(new templatecastlib::SessionStartEvent{ 9876, std::chrono::system_clock::now(), id, i });
+            events.emplace_back(new templatecastlib::SessionEndEvent{ 9876, std::chrono::system_clock::now(), id, i });
+            events.emplace_back(new templatecastlib::AuthLoginEvent{ 6789, std::chrono::system_clock::now(), id, i });
+            events.emplace_back(new templatecastlib::AuthLogoutEvent{ 6789, std::chrono::system_clock::now(), id, i });
+        }
+        benchmark::DoNotOptimize(events.data());
+        events.clear();
+        events.shrink_to_fit();
+    }
+    reportAllocations(state, scope.stats());
+}
+BENCHMARK(BM_alloc_templatecast)->Arg(8)->Arg(32);
+
+
+int main(int argc, char ** argv)
+{
+    // --perf_counters must be removed before google benchmark sees it and complains about an unknown flag
+    benchapp::PerfCounters::parseCommandLine(argc, argv);
+
+    int kept = 1;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--layout_report") == 0)
+        {
+            benchapp::printLayoutReport(std::cout);
+            continue;
+        }
+        argv[kept++] = argv[i];
+    }
+    argc = kept;
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
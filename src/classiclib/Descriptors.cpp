@@ -0,0 +1,84 @@
+#include "classiclib/Events.hpp"
+
+#include "commonlib/FieldDescriptor.hpp"
+
+#include <stdexcept>
+
+
+namespace classiclib {
+
+namespace
+{
+
+using commonlib::describeField;
+
+// Base members first, in the order handleEvent writes them. Labels are the handler's own text
+constexpr commonlib::FieldDescriptor s_sessionStartFields[] =
+{
+    describeField<SessionStartEvent, &SessionStartEvent::pid_>("pid", "PID is "),
+    describeField<SessionStartEvent, &SessionStartEvent::timestamp_>("timestamp", "Timestamp is "),
+    describeField<SessionStartEvent, &SessionStartEvent::sessionId_>("sessionId", "Session id is "),
+    describeField<SessionStartEvent, &SessionStartEvent::someSpecificData_>("someSpecificData", "Some specific data for session start: "),
+};
+
+constexpr commonlib::FieldDescriptor s_sessionEndFields[] =
+{
+    describeField<SessionEndEvent, &SessionEndEvent::pid_>("pid", "PID is "),
+    describeField<SessionEndEvent, &SessionEndEvent::timestamp_>("timestamp", "Timestamp is "),
+    describeField<SessionEndEvent, &SessionEndEvent::sessionId_>("sessionId", "Session id is "),
+    describeField<SessionEndEvent, &SessionEndEvent::someSpecificData_>("someSpecificData", "Some specific data for session end: "),
+};
+
+constexpr commonlib::FieldDescriptor s_authLoginFields[] =
+{
+    describeField<AuthLoginEvent, &AuthLoginEvent::pid_>("pid", "PID is "),
+    describeField<AuthLoginEvent, &AuthLoginEvent::timestamp_>("timestamp", "Timestamp is "),
+    describeField<AuthLoginEvent, &AuthLoginEvent::userId_>("userId", "User is "),
+    describeField<AuthLoginEvent, &AuthLoginEvent::someSpecificData_>("someSpecificData", "Some specific data for auth login: "),
+};
+
+constexpr commonlib::FieldDescriptor s_authLogoutFields[] =
+{
+    describeField<AuthLogoutEvent, &AuthLogoutEvent::pid_>("pid", "PID is "),
+    describeField<AuthLogoutEvent, &AuthLogoutEvent::timestamp_>("timestamp", "Timestamp is "),
+    describeField<AuthLogoutEvent, &AuthLogoutEvent::userId_>("userId", "User is "),
+    describeField<AuthLogoutEvent, &AuthLogoutEvent::someSpecificData_>("someSpecificData", "Some specific data for auth logout: "),
+};
+
+constexpr commonlib::TypeDescriptor s_sessionStart{ "SessionStartEvent", commonlib::EventKind::SESSION_START, s_sessionStartFields };
+constexpr commonlib::TypeDescriptor s_sessionEnd{ "SessionEndEvent", commonlib::EventKind::SESSION_END, s_sessionEndFields };
+constexpr commonlib::TypeDescriptor s_authLogin{ "AuthLoginEvent", commonlib::EventKind::AUTH_LOGIN, s_authLoginFields };
+constexpr commonlib::TypeDescriptor s_authLogout{ "AuthLogoutEvent", commonlib::EventKind::AUTH_LOGOUT, s_authLogoutFields };
+
+template <class T>
+commonlib::DescribedEvent describeAs(const EventBase * event, const commonlib::TypeDescriptor & type)
+{
+    auto concreteEvent = dynamic_cast<const T *>(event);
+    if(!concreteEvent)
+    {
+        throw std::runtime_error("Cast to concrete event type failed");
+    }
+    return commonlib::DescribedEvent{ &type, concreteEvent };
+}
+
+} // end anonymous namespace
+
+commonlib::DescribedEvent describe(const EventBase * event)
+{
+    if(!event)
+    {
+        throw std::invalid_argument("Event is not valid");
+    }
+
+    switch(event->type_)
+    {
+        case EventType::SESSION_START: return describeAs<SessionStartEvent>(event, s_sessionStart);
+        case EventType::SESSION_END:   return describeAs<SessionEndEvent>(event, s_sessionEnd);
+        case EventType::AUTH_LOGIN:    return describeAs<AuthLoginEvent>(event, s_authLogin);
+        case EventType::AUTH_LOGOUT:   return describeAs<AuthLogoutEvent>(event, s_authLogout);
+        default:
+            throw std::invalid_argument("Unknown event type encountered");
+    }
+}
+
+} // end namespace classiclib
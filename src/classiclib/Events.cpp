@@ -1,5 +1,7 @@
 #include "classiclib/Events.hpp"
-#include <iomanip>
+
+#include "commonlib/Hash.hpp"
+
 #include <stdexcept>
 
 
@@ -43,171 +45,128 @@ AuthLogoutEvent::AuthLogoutEvent(short pid, std::chrono::system_clock::time_poin
     , someSpecificData_(someSpecificData)
 {}
 
-void handleAuthEvent(const AuthEventBase * authEvent, std::ostream & out)
+std::unique_ptr<EventBase> makeEvent(const commonlib::ParsedEvent & parsed)
 {
-    if (!authEvent)
+    const std::string id(parsed.id_);
+    switch(parsed.kind_)
     {
-        throw std::invalid_argument("Auth event is not valid");
+        case commonlib::EventKind::SESSION_START: return std::make_unique<SessionStartEvent>(parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_);
+        case commonlib::EventKind::SESSION_END:   return std::make_unique<SessionEndEvent>(parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_);
+        case commonlib::EventKind::AUTH_LOGIN:    return std::make_unique<AuthLoginEvent>(parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_);
+        case commonlib::EventKind::AUTH_LOGOUT:   return std::make_unique<AuthLogoutEvent>(parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_);
     }
+    throw std::invalid_argument("Unknown event type encountered");
+}
 
-    if(!out)
+commonlib::EventKind eventKind(const EventBase * event)
+{
+    if(!event)
     {
-        throw std::invalid_argument("Output stream is not valid");
+        throw std::invalid_argument("Event is not valid");
     }
 
-    out << "User is " << authEvent->userId_ << "\n";
-
-    switch(authEvent->type_)
+    switch(event->type_)
     {
-        case EventType::AUTH_LOGIN:
-        {
-            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
-               then we could static_cast, but if they do mislabel then we run the risk of UB
-            auto loginEvent = static_cast<const AuthLoginEvent *>(authEvent);
-            */
-            auto loginEvent = dynamic_cast<const AuthLoginEvent *>(authEvent);
-            if(!loginEvent) 
-            { 
-                throw std::runtime_error("Cast to auth login event type failed");
-            }
-
-            out << "Some specific data for auth login: " << loginEvent->someSpecificData_ << std::endl;
-            break;
-        }
-        case EventType::AUTH_LOGOUT:
-        {
-            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
-               then we could static_cast, but if they do mislabel then we run the risk of UB
-            auto logoutEvent = static_cast<const AuthLogoutEvent *>(authEvent);
-            */
-            auto logoutEvent = dynamic_cast<const AuthLogoutEvent *>(authEvent);
-            if(!logoutEvent) 
-            { 
-                throw std::runtime_error("Cast to auth logout event type failed");
-            }
-
-            out << "Some specific data for auth logout: " << logoutEvent->someSpecificData_ << std::endl;
-            break;
-        }
+        case EventType::SESSION_START: return commonlib::EventKind::SESSION_START;
+        case EventType::SESSION_END:   return commonlib::EventKind::SESSION_END;
+        case EventType::AUTH_LOGIN:    return commonlib::EventKind::AUTH_LOGIN;
+        case EventType::AUTH_LOGOUT:   return commonlib::EventKind::AUTH_LOGOUT;
         default:
-        {
-            throw std::invalid_argument("Unknown auth event type encountered");
-            break;
-        }
+            throw std::invalid_argument("Unknown event type encountered");
     }
 }
 
-void handleSessionEvent(const SessionEventBase * sessionEvent, std::ostream & out)
+std::uint64_t samplingKey(const EventBase * event)
 {
-    if (!sessionEvent)
-    {
-        throw std::invalid_argument("Session event is not valid");
-    }
-    
-    if(!out)
+    if(!event)
     {
-        throw std::invalid_argument("Output stream is not valid");
+        throw std::invalid_argument("Event is not valid");
     }
 
-    out << "Session id is " << sessionEvent->sessionId_ << std::endl;
-
-    switch(sessionEvent->type_)
+    switch(event->type_)
     {
         case EventType::SESSION_START:
+        case EventType::SESSION_END:
         {
-            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
-               then we could static_cast, but if they do mislabel then we run the risk of UB
-            auto startEvent = static_cast<const SessionStartEvent *>(sessionEvent);
-            */
-            auto startEvent = dynamic_cast<const SessionStartEvent *>(sessionEvent);
-            if(!startEvent)
-            { 
-                throw std::runtime_error("Cast to session start event type failed");
+            auto sessionEvent = dynamic_cast<const SessionEventBase *>(event);
+            if(!sessionEvent)
+            {
+                throw std::runtime_error("Cast to session event type failed");
             }
-
-            out << "Some specific data for session start: " << startEvent->someSpecificData_ << std::endl;
-            break;
+            return commonlib::hashBytes(sessionEvent->sessionId_);
         }
-        case EventType::SESSION_END:
+        case EventType::AUTH_LOGIN:
+        case EventType::AUTH_LOGOUT:
         {
-            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
-               then we could static_cast, but if they do mislabel then we run the risk of UB
-            auto endEvent = static_cast<const SessionEndEvent *>(sessionEvent);
-            */
-            auto endEvent = dynamic_cast<const SessionEndEvent *>(sessionEvent);
-            if(!endEvent)
-            { 
-                throw std::runtime_error("Cast to session end event type failed");
+            auto authEvent = dynamic_cast<const AuthEventBase *>(event);
+            if(!authEvent)
+            {
+                throw std::runtime_error("Cast to auth event type failed");
             }
-
-            out << "Some specific data for session end: " << endEvent->someSpecificData_ << std::endl;
-            break;
+            return commonlib::hashBytes(authEvent->userId_);
         }
         default:
-        {
-            throw std::runtime_error("Unknown session event type encountered");
-            break;
-        }
+            throw std::invalid_argument("Unknown event type encountered");
     }
 }
 
-void handleEvent(const EventBase * event, std::ostream & out)
+std::uint64_t fingerprint(const EventBase * event)
 {
     if(!event)
     {
         throw std::invalid_argument("Event is not valid");
     }
 
-    if(!out)
-    {
-        throw std::invalid_argument("Output stream is not valid");
-    }
-
-    out << "PID is " << event->pid_ << std::endl;
-
-    std::time_t time = std::chrono::system_clock::to_time_t(event->timestamp_);
-    std::tm tm = *std::localtime(&time); // Convert to local time
-    out << "Timestamp is " << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << std::endl;
+    std::uint64_t hash = commonlib::combineHash(event->type_, static_cast<std::uint64_t>(event->pid_));
+    hash = commonlib::combineHash(hash, static_cast<std::uint64_t>(event->timestamp_.time_since_epoch().count()));
 
     switch(event->type_)
     {
         case EventType::SESSION_START:
         case EventType::SESSION_END:
         {
-            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
-               then we could static_cast, but if they do mislabel then we run the risk of UB
-            auto sessionEvent = static_cast<const SessionEventBase *>(event);
-            */
             auto sessionEvent = dynamic_cast<const SessionEventBase *>(event);
-            if(!sessionEvent) 
-            { 
-                throw std::runtime_error("Cast to session event type failed"); 
+            if(!sessionEvent)
+            {
+                throw std::runtime_error("Cast to session event type failed");
             }
+            hash = commonlib::hashBytes(sessionEvent->sessionId_, hash);
 
-            handleSessionEvent(sessionEvent, out);
-            break;
+            int someSpecificData = event->type_ == EventType::SESSION_START
+                ? dynamic_cast<const SessionStartEvent &>(*sessionEvent).someSpecificData_
+                : dynamic_cast<const SessionEndEvent &>(*sessionEvent).someSpecificData_;
+            return commonlib::combineHash(hash, static_cast<std::uint32_t>(someSpecificData));
         }
         case EventType::AUTH_LOGIN:
         case EventType::AUTH_LOGOUT:
         {
-            /* If we want to avoid dynamic_cast and hope no programmer makes mistakes with the type enum
-               then we could static_cast, but if they do mislabel then we run the risk of UB
-            auto authEvent = static_cast<const AuthEventBase *>(event);
-            */
             auto authEvent = dynamic_cast<const AuthEventBase *>(event);
             if(!authEvent)
-            { 
-                throw std::runtime_error("Cast to session event type failed"); 
+            {
+                throw std::runtime_error("Cast to auth event type failed");
             }
+            hash = commonlib::hashBytes(authEvent->userId_, hash);
 
-            handleAuthEvent(authEvent, out);
-            break;
+            int someSpecificData = event->type_ == EventType::AUTH_LOGIN
+                ? dynamic_cast<const AuthLoginEvent &>(*authEvent).someSpecificData_
+                : dynamic_cast<const AuthLogoutEvent &>(*authEvent).someSpecificData_;
+            return commonlib::combineHash(hash, static_cast<std::uint32_t>(someSpecificData));
         }
         default:
-            // Handle unknown event type
             throw std::invalid_argument("Unknown event type encountered");
-            break;
     }
 }
 
-} // end namespace classiclib
\ No newline at end of file
+void handleEvent(const EventBase * event, std::ostream & out)
+{
+    if(!out)
+    {
+        throw std::invalid_argument("Output stream is not valid");
+    }
+
+    commonlib::OstreamSink sink(out);
+    handleEvent(event, sink);
+    out.flush();
+}
+
+} // end namespace classiclib
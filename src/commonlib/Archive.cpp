@@ -0,0 +1,566 @@
+#include "commonlib/Archive.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+
+namespace commonlib
+{
+
+// Packed words are loaded and stored with memcpy, which only gives the documented byte order on a little endian host
+static_assert(std::endian::native == std::endian::little, "The archive format is only implemented for little endian hosts");
+
+namespace
+{
+
+constexpr std::string_view s_magic = "EVB1";
+constexpr std::size_t s_headerBytes = 28;
+constexpr std::size_t s_padding = 8;
+
+std::uint64_t zigzag(std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(std::uint64_t value)
+{
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+/* Bits needed for the largest value
+   Widths over 56 go up to 64, which keeps every value inside the 8 byte word loaded at its first byte */
+unsigned packedWidth(std::uint64_t largest)
+{
+    const auto width = static_cast<unsigned>(std::bit_width(largest));
+    return width > 56 ? 64 : width;
+}
+
+std::size_t packedBytes(unsigned width, std::size_t count)
+{
+    return (count * width + 7) / 8 + s_padding;
+}
+
+std::uint64_t loadWord(const char * bytes)
+{
+    std::uint64_t word;
+    std::memcpy(&word, bytes, sizeof(word));
+    return word;
+}
+
+void appendPacked(std::string & out, const std::vector<std::uint64_t> & values)
+{
+    std::uint64_t largest = 0;
+    for(auto value : values)
+    {
+        largest |= value;
+    }
+    const unsigned width = packedWidth(largest);
+    out.push_back(static_cast<char>(width));
+
+    const std::size_t start = out.size();
+    out.append(packedBytes(width, values.size()), '\0');
+    if(width == 0)
+    {
+        return;
+    }
+
+    char * packed = out.data() + start;
+    for(std::size_t i = 0; i < values.size(); ++i)
+    {
+        const std::size_t bit = i * width;
+        std::uint64_t word = loadWord(packed + bit / 8);
+        word |= values[i] << (bit % 8);
+        std::memcpy(packed + bit / 8, &word, sizeof(word));
+    }
+}
+
+// Seven bits a byte, low first, the top bit set on all but the last
+void appendVarint(std::string & out, std::uint64_t value)
+{
+    while(value >= 0x80)
+    {
+        out.push_back(static_cast<char>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+// Sorted distinct values, then each value's index among them
+void appendDictionary(std::string & out, const std::vector<std::uint16_t> & values)
+{
+    std::vector<std::uint16_t> entries(values);
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+
+    appendLittleEndian(out, static_cast<std::uint32_t>(entries.size()));
+    for(auto entry : entries)
+    {
+        appendLittleEndian(out, entry);
+    }
+
+    std::vector<std::uint64_t> indexes(values.size());
+    for(std::size_t i = 0; i < values.size(); ++i)
+    {
+        indexes[i] = static_cast<std::uint64_t>(std::lower_bound(entries.begin(), entries.end(), values[i]) - entries.begin());
+    }
+    appendPacked(out, indexes);
+}
+
+void unpackScalar(const char * packed, unsigned width, std::size_t count, std::uint64_t * values)
+{
+    if(width == 0)
+    {
+        std::fill(values, values + count, 0);
+        return;
+    }
+
+    const std::uint64_t mask = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        const std::size_t bit = i * width;
+        values[i] = (loadWord(packed + bit / 8) >> (bit % 8)) & mask;
+    }
+}
+
+#if defined(__x86_64__)
+// Built for AVX2 whatever the compiler flags, and only called when the CPU has it
+__attribute__((target("avx2")))
+void unpackAvx2(const char * packed, unsigned width, std::size_t count, std::uint64_t * values)
+{
+    if(width == 0)
+    {
+        std::fill(values, values + count, 0);
+        return;
+    }
+
+    const std::uint64_t mask = width == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << width) - 1;
+    const __m256i maskVector = _mm256_set1_epi64x(static_cast<long long>(mask));
+    const __m256i step = _mm256_set1_epi64x(4 * static_cast<long long>(width));
+    const __m256i byteBits = _mm256_set1_epi64x(7);
+    __m256i bits = _mm256_setr_epi64x(0, width, 2 * width, 3 * width);
+
+    std::size_t i = 0;
+    for(; i + 4 <= count; i += 4)
+    {
+        // Four words, each starting at the byte holding its value's first bit
+        const __m256i words = _mm256_i64gather_epi64(reinterpret_cast<const long long *>(packed), _mm256_srli_epi64(bits, 3), 1);
+        const __m256i shifted = _mm256_srlv_epi64(words, _mm256_and_si256(bits, byteBits));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(values + i), _mm256_and_si256(shifted, maskVector));
+        bits = _mm256_add_epi64(bits, step);
+    }
+    for(; i < count; ++i)
+    {
+        const std::size_t bit = i * width;
+        values[i] = (loadWord(packed + bit / 8) >> (bit % 8)) & mask;
+    }
+}
+#endif
+
+// Reads the fields of one block, throwing rather than reading past its end
+class BlockReader
+{
+public:
+    explicit BlockReader(std::string_view block)
+        : m_block(block)
+        , m_offset(0)
+    {}
+
+    std::string_view bytes(std::size_t size)
+    {
+        if(size > m_block.size() - m_offset)
+        {
+            throw std::runtime_error("Archive block is truncated");
+        }
+        auto bytes = m_block.substr(m_offset, size);
+        m_offset += size;
+        return bytes;
+    }
+
+    template <class T>
+    T read()
+    {
+        using Unsigned = std::make_unsigned_t<T>;
+        auto data = bytes(sizeof(T));
+        Unsigned value = 0;
+        for(std::size_t i = 0; i < sizeof(T); ++i)
+        {
+            value |= static_cast<Unsigned>(static_cast<unsigned char>(data[i])) << (8 * i);
+        }
+        return static_cast<T>(value);
+    }
+
+    std::uint64_t varint()
+    {
+        std::uint64_t value = 0;
+        for(unsigned shift = 0; shift < 64; shift += 7)
+        {
+            const auto byte = read<std::uint8_t>();
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if((byte & 0x80) == 0)
+            {
+                return value;
+            }
+        }
+        throw std::runtime_error("Archive varint is too long");
+    }
+
+    // Unpack the next packed column of count values
+    void unpack(void (*unpack)(const char *, unsigned, std::size_t, std::uint64_t *), std::size_t count, std::uint64_t * values)
+    {
+        const unsigned width = read<std::uint8_t>();
+        if(width > 64)
+        {
+            throw std::runtime_error("Archive column has a bad bit width");
+        }
+        unpack(bytes(packedBytes(width, count)).data(), width, count, values);
+    }
+
+private:
+    std::string_view m_block;
+    std::size_t m_offset;
+};
+
+} // end anonymous namespace
+
+ArchiveWriter::ArchiveWriter(std::size_t blockEvents, std::size_t blockIdBytes)
+    : m_blockEvents(blockEvents)
+    , m_blockIdBytes(blockIdBytes)
+    , m_events(0)
+    , m_idBytes(0)
+{
+    if(blockEvents == 0)
+    {
+        throw std::invalid_argument("Archive blocks must hold at least one event");
+    }
+    if(blockEvents > MaxBlockEvents)
+    {
+        throw std::invalid_argument("Archive blocks can hold at most " + std::to_string(MaxBlockEvents) + " events");
+    }
+    if(blockIdBytes == 0 || blockIdBytes > MaxBlockIdBytes)
+    {
+        throw std::invalid_argument("Archive block id bytes must be from 1 to " + std::to_string(MaxBlockIdBytes));
+    }
+}
+
+void ArchiveWriter::append(const DescribedEvent & event)
+{
+    short pid = 0;
+    std::chrono::system_clock::time_point timestamp;
+    std::string_view id;
+    int someSpecificData = 0;
+    for(const auto & field : event.type_->fields_)
+    {
+        const void * value = field.address_(event.object_);
+        switch(field.type_)
+        {
+            case FieldType::INT16:     pid = *static_cast<const short *>(value); break;
+            case FieldType::INT32:     someSpecificData = *static_cast<const int *>(value); break;
+            case FieldType::TIMESTAMP: timestamp = *static_cast<const std::chrono::system_clock::time_point *>(value); break;
+            case FieldType::STRING:    id = *static_cast<const std::string *>(value); break;
+        }
+    }
+    add(event.type_->kind_, pid, timestamp, id, someSpecificData);
+}
+
+void ArchiveWriter::append(const ParsedEvent & event)
+{
+    add(event.kind_, event.pid_, event.timestamp_, event.id_, event.someSpecificData_);
+}
+
+void ArchiveWriter::finish()
+{
+    encodeBlock();
+}
+
+void ArchiveWriter::add(EventKind kind, short pid, std::chrono::system_clock::time_point timestamp, std::string_view id, int someSpecificData)
+{
+    auto found = m_idDictionary.find(id);
+    if(found == m_idDictionary.end())
+    {
+        if(id.size() > m_blockIdBytes)
+        {
+            throw std::length_error("Archive id is longer than a block's ids may be in total");
+        }
+        // Long distinct ids end the block early, rather than take it past what its header can describe
+        if(m_idBytes + id.size() > m_blockIdBytes)
+        {
+            encodeBlock();
+        }
+        found = m_idDictionary.emplace(std::string(id), static_cast<std::uint32_t>(m_idEntries.size())).first;
+        m_idEntries.push_back(found->first);
+        m_idBytes += id.size();
+    }
+    m_idIndexes.push_back(found->second);
+
+    m_kinds.push_back(static_cast<std::uint16_t>(kind));
+    m_pids.push_back(static_cast<std::uint16_t>(pid));
+    m_timestamps.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count());
+    m_data.push_back(someSpecificData);
+
+    ++m_events;
+    if(m_kinds.size() == m_blockEvents)
+    {
+        encodeBlock();
+    }
+}
+
+void ArchiveWriter::encodeBlock()
+{
+    const std::size_t count = m_kinds.size();
+    if(count == 0)
+    {
+        return;
+    }
+
+    const std::size_t start = m_output.size();
+    const auto [minTimestamp, maxTimestamp] = std::minmax_element(m_timestamps.begin(), m_timestamps.end());
+    m_output.append(s_magic);
+    appendLittleEndian(m_output, static_cast<std::uint32_t>(count));
+    appendLittleEndian(m_output, std::uint32_t(0));                 // Block bytes, filled in at the end
+    appendLittleEndian(m_output, *minTimestamp);
+    appendLittleEndian(m_output, *maxTimestamp);
+
+    appendDictionary(m_output, m_kinds);
+    appendDictionary(m_output, m_pids);
+
+    // Differences are taken modulo 2^64, so any timestamps round trip whatever the deltas
+    std::vector<std::uint64_t> values;
+    const auto timestamp = [this](std::size_t i) { return static_cast<std::uint64_t>(m_timestamps[i]); };
+    const std::uint64_t firstDelta = count > 1 ? timestamp(1) - timestamp(0) : 0;
+    appendLittleEndian(m_output, m_timestamps[0]);
+    appendLittleEndian(m_output, firstDelta);
+    for(std::size_t i = 2; i < count; ++i)
+    {
+        const std::uint64_t deltaOfDelta = (timestamp(i) - timestamp(i - 1)) - (timestamp(i - 1) - timestamp(i - 2));
+        values.push_back(zigzag(static_cast<std::int64_t>(deltaOfDelta)));
+    }
+    appendPacked(m_output, values);
+
+    appendLittleEndian(m_output, static_cast<std::uint32_t>(m_idEntries.size()));
+    for(auto id : m_idEntries)
+    {
+        appendVarint(m_output, id.size());
+        m_output.append(id);
+    }
+    values.assign(m_idIndexes.begin(), m_idIndexes.end());
+    appendPacked(m_output, values);
+
+    const std::int32_t minData = *std::min_element(m_data.begin(), m_data.end());
+    appendLittleEndian(m_output, minData);
+    values.clear();
+    for(auto data : m_data)
+    {
+        values.push_back(static_cast<std::uint32_t>(data) - static_cast<std::uint32_t>(minData));
+    }
+    appendPacked(m_output, values);
+
+    // Not reachable within MaxBlockEvents and MaxBlockIdBytes, but a corrupt header must never be written
+    if(m_output.size() - start > std::numeric_limits<std::uint32_t>::max())
+    {
+        m_output.resize(start);
+        throw std::length_error("Archive block is over 4 GiB");
+    }
+    const auto blockBytes = static_cast<std::uint32_t>(m_output.size() - start);
+    for(std::size_t i = 0; i < sizeof(blockBytes); ++i)
+    {
+        m_output[start + 8 + i] = static_cast<char>(blockBytes >> (8 * i));
+    }
+
+    m_kinds.clear();
+    m_pids.clear();
+    m_timestamps.clear();
+    m_idIndexes.clear();
+    m_idEntries.clear();
+    m_idDictionary.clear();
+    m_idBytes = 0;
+    m_data.clear();
+}
+
+bool ArchiveReader::supported(Unpack unpack)
+{
+    switch(unpack)
+    {
+        case AUTO:
+        case SCALAR:
+            return true;
+#if defined(__x86_64__)
+        case AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+ArchiveReader::ArchiveReader(std::string_view data, Unpack unpack)
+    : m_data(data)
+    , m_offset(0)
+    , m_skipped(0)
+    , m_unpack(unpackScalar)
+{
+    if(!supported(unpack))
+    {
+        throw std::invalid_argument("Requested SIMD unpack is not supported on this CPU");
+    }
+
+#if defined(__x86_64__)
+    if(unpack == AVX2 || (unpack == AUTO && supported(AVX2)))
+    {
+        m_unpack = unpackAvx2;
+    }
+#endif
+}
+
+bool ArchiveReader::nextBlock(std::vector<ParsedEvent> & events)
+{
+    return nextBlock(events, std::chrono::system_clock::time_point::min(), std::chrono::system_clock::time_point::max());
+}
+
+bool ArchiveReader::nextBlock(std::vector<ParsedEvent> & events, std::chrono::system_clock::time_point from, std::chrono::system_clock::time_point to)
+{
+    const auto nanoseconds = [](std::chrono::system_clock::time_point timestamp)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+    };
+
+    while(m_offset < m_data.size())
+    {
+        BlockReader header(m_data.substr(m_offset));
+        if(header.bytes(s_magic.size()) != s_magic)
+        {
+            throw std::runtime_error("Not an event archive block");
+        }
+        const auto count = header.read<std::uint32_t>();
+        const auto blockBytes = header.read<std::uint32_t>();
+        const auto minTimestamp = header.read<std::int64_t>();
+        const auto maxTimestamp = header.read<std::int64_t>();
+        if(count == 0 || blockBytes < s_headerBytes || blockBytes > m_data.size() - m_offset)
+        {
+            throw std::runtime_error("Archive block is truncated");
+        }
+        if(count > ArchiveWriter::MaxBlockEvents)
+        {
+            throw std::runtime_error("Archive block event count is corrupt");
+        }
+
+        const auto block = m_data.substr(m_offset, blockBytes);
+        m_offset += blockBytes;
+        if(maxTimestamp < nanoseconds(from) || minTimestamp >= nanoseconds(to))
+        {
+            ++m_skipped;
+            continue;
+        }
+
+        decodeBlock(block, count, events);
+        return true;
+    }
+    return false;
+}
+
+void ArchiveReader::decodeBlock(std::string_view block, std::size_t count, std::vector<ParsedEvent> & events)
+{
+    BlockReader reader(block);
+    reader.bytes(s_headerBytes);
+    events.resize(count);
+    m_values.resize(count);
+    std::uint64_t * values = m_values.data();
+
+    // Kinds and pids are both dictionaries of 16 bit values
+    auto & entries = m_entries;
+    const auto readDictionary = [&]
+    {
+        const auto size = reader.read<std::uint32_t>();
+        if(size == 0 || size > count || size > 65536)
+        {
+            throw std::runtime_error("Archive dictionary has a bad size");
+        }
+        entries.resize(size);
+        for(auto & entry : entries)
+        {
+            entry = reader.read<std::uint16_t>();
+        }
+        reader.unpack(m_unpack, count, values);
+        if(*std::max_element(values, values + count) >= size)
+        {
+            throw std::runtime_error("Archive dictionary index out of range");
+        }
+        return size;
+    };
+
+    readDictionary();
+    for(auto entry : entries)
+    {
+        if(entry >= EventKindCount)
+        {
+            throw std::runtime_error("Archive block has an unknown event kind");
+        }
+    }
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        events[i].kind_ = static_cast<EventKind>(entries[values[i]]);
+    }
+
+    readDictionary();
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        events[i].pid_ = static_cast<short>(entries[values[i]]);
+    }
+
+    // Two running sums undo the delta of delta, modulo 2^64 as on the way in
+    auto timestamp = static_cast<std::uint64_t>(reader.read<std::int64_t>());
+    auto delta = reader.read<std::uint64_t>();
+    const std::size_t deltas = count > 2 ? count - 2 : 0;
+    reader.unpack(m_unpack, deltas, values);
+    const auto toTimePoint = [](std::uint64_t nanoseconds)
+    {
+        return std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(static_cast<std::int64_t>(nanoseconds))));
+    };
+    events[0].timestamp_ = toTimePoint(timestamp);
+    for(std::size_t i = 1; i < count; ++i)
+    {
+        if(i >= 2)
+        {
+            delta += static_cast<std::uint64_t>(unzigzag(values[i - 2]));
+        }
+        timestamp += delta;
+        events[i].timestamp_ = toTimePoint(timestamp);
+    }
+
+    const auto ids = reader.read<std::uint32_t>();
+    if(ids == 0 || ids > count)
+    {
+        throw std::runtime_error("Archive dictionary has a bad size");
+    }
+    m_ids.resize(ids);
+    for(auto & id : m_ids)
+    {
+        id = reader.bytes(reader.varint());
+    }
+    reader.unpack(m_unpack, count, values);
+    if(*std::max_element(values, values + count) >= ids)
+    {
+        throw std::runtime_error("Archive dictionary index out of range");
+    }
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        events[i].id_ = m_ids[values[i]];
+    }
+
+    const auto minData = static_cast<std::uint32_t>(reader.read<std::int32_t>());
+    reader.unpack(m_unpack, count, values);
+    for(std::size_t i = 0; i < count; ++i)
+    {
+        events[i].someSpecificData_ = static_cast<std::int32_t>(minData + static_cast<std::uint32_t>(values[i]));
+        events[i].weight_ = 1.0;
+    }
+}
+
+} // end namespace commonlib
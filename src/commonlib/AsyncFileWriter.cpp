@@ -0,0 +1,844 @@
+#include "commonlib/AsyncFileWriter.hpp"
+
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+
+namespace commonlib
+{
+
+namespace
+{
+
+constexpr std::size_t s_blockSize = AsyncFileWriter::BlockSize;
+
+[[noreturn]] void throwErrno(int error, const char * what)
+{
+    throw std::system_error(error, std::generic_category(), what);
+}
+
+// From acquire() when it would wait for a buffer that only the caller can give back
+[[noreturn]] void throwAllHeld()
+{
+    throw std::logic_error("Every async file buffer is acquired and none is being written: submit one first");
+}
+
+// Write all of [data, data + length) at offset, retrying short writes
+int writeFully(int fd, const char * data, std::size_t length, off_t offset)
+{
+    while(length > 0)
+    {
+        ssize_t written = pwrite(fd, data, length, offset);
+        if(written < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            return errno;
+        }
+        data += written;
+        length -= static_cast<std::size_t>(written);
+        offset += written;
+    }
+    return 0;
+}
+
+/* Buffer ownership, ordering of file offsets and closing, shared by both backends
+   Backends only have to start a write and wait for writes to complete. */
+class WriterBase : public AsyncFileWriter
+{
+public:
+    void submit(Buffer * buffer) override
+    {
+        checkError();
+        if(m_directIO && buffer->size_ % s_blockSize != 0)
+        {
+            throw std::invalid_argument("Direct I/O buffers must be filled to a multiple of the block size");
+        }
+        if(buffer->size_ == 0)
+        {
+            release(buffer);
+            return;
+        }
+
+        // The buffer belongs to the backend once its write starts, so take its size first
+        const off_t offset = m_offset;
+        m_offset += static_cast<off_t>(buffer->size_);
+        startWrite(buffer, offset, buffer->size_);
+    }
+
+    void flush() override
+    {
+        waitAll();
+        checkError();
+    }
+
+    void close(Buffer * last) override
+    {
+        if(m_fd < 0)
+        {
+            return;
+        }
+
+        off_t logicalSize = m_offset;
+        if(last && last->size_ > 0)
+        {
+            logicalSize += static_cast<off_t>(last->size_);
+
+            // O_DIRECT can only write whole blocks, so pad with zeros and truncate the file afterwards
+            std::size_t length = last->size_;
+            if(m_directIO)
+            {
+                length = (length + s_blockSize - 1) / s_blockSize * s_blockSize;
+                std::memset(last->data_ + last->size_, 0, length - last->size_);
+            }
+            startWrite(last, m_offset, length);
+            m_offset += static_cast<off_t>(length);
+        }
+        else if(last)
+        {
+            release(last);
+        }
+
+        waitAll();
+        stop();
+
+        if(m_offset != logicalSize && ftruncate(m_fd, logicalSize) != 0 && m_error == 0)
+        {
+            m_error = errno;
+        }
+        ::close(m_fd);
+        m_fd = -1;
+
+        checkError();
+    }
+
+    bool directIO() const override
+    {
+        return m_directIO;
+    }
+
+protected:
+    WriterBase(int fd, bool directIO, const AsyncFileWriterOptions & options)
+        : m_fd(fd)
+        , m_directIO(directIO)
+        , m_offset(0)
+        , m_error(0)
+    {
+        std::size_t capacity = std::max<std::size_t>(options.bufferSize_, s_blockSize);
+        capacity = (capacity + s_blockSize - 1) / s_blockSize * s_blockSize;
+
+        std::size_t count = std::max<std::size_t>(options.bufferCount_, 2);
+        m_buffers.resize(count);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            char * data = static_cast<char *>(std::aligned_alloc(s_blockSize, capacity));
+            if(!data)
+            {
+                releaseBuffers();
+                throw std::bad_alloc();
+            }
+            m_buffers[i] = Buffer{ data, capacity, 0, static_cast<unsigned>(i) };
+        }
+    }
+
+    ~WriterBase() override
+    {
+        if(m_fd >= 0)
+        {
+            ::close(m_fd);
+        }
+        releaseBuffers();
+    }
+
+    // Called by the derived destructor, while the backend still exists
+    void closeQuietly() noexcept
+    {
+        try
+        {
+            close(nullptr);
+        }
+        catch(...)
+        {
+        }
+    }
+
+    void checkError() const
+    {
+        if(m_error != 0)
+        {
+            throwErrno(m_error, "Async file write failed");
+        }
+    }
+
+    // Start writing length bytes of buffer at offset. The buffer comes back through release() when done
+    virtual void startWrite(Buffer * buffer, off_t offset, std::size_t length) = 0;
+
+    /* Wait until no write is in flight
+       Write errors are only recorded in m_error, so close() can still stop, truncate and close before reporting them */
+    virtual void waitAll() = 0;
+
+    // Stop any background work. Nothing is in flight when called
+    virtual void stop() {}
+
+    // Give a written buffer back to the pool
+    virtual void release(Buffer * buffer) = 0;
+
+    int m_fd;
+    const bool m_directIO;
+    off_t m_offset;                         // Where the next submitted buffer goes
+    int m_error;                            // First errno from a failed write
+    std::vector<Buffer> m_buffers;
+
+private:
+    void releaseBuffers()
+    {
+        for(auto & buffer : m_buffers)
+        {
+            std::free(buffer.data_);
+            buffer.data_ = nullptr;
+        }
+    }
+};
+
+
+/* io_uring backend, using the raw system calls
+   Writes are queued by the producer thread itself and complete in the kernel, so no extra thread is involved. Buffers
+   are registered with the ring when the memlock limit allows it, saving the page pinning on every write. */
+class IoUringWriter : public WriterBase
+{
+public:
+    IoUringWriter(int fd, bool directIO, const AsyncFileWriterOptions & options)
+        : WriterBase(fd, directIO, options)
+        , m_ringFd(-1)
+        , m_sqRing(MAP_FAILED)
+        , m_cqRing(MAP_FAILED)
+        , m_sqes(MAP_FAILED)
+        , m_registered(false)
+        , m_inFlight(0)
+        , m_writes(m_buffers.size())
+    {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+
+        m_ringFd = static_cast<int>(syscall(__NR_io_uring_setup, static_cast<unsigned>(m_buffers.size()), &params));
+        if(m_ringFd < 0)
+        {
+            int error = errno;
+            m_fd = -1;
+            throwErrno(error, "io_uring_setup failed");
+        }
+
+        try
+        {
+            mapRings(params);
+
+            // A kernel can have io_uring but not the write opcodes, and then every write would fail with EINVAL
+            const std::vector<bool> supported = supportedOps();
+            const bool write = supported[IORING_OP_WRITE];
+            const bool writeFixed = supported[IORING_OP_WRITE_FIXED];
+
+            std::vector<iovec> iovecs;
+            for(auto & buffer : m_buffers)
+            {
+                iovecs.push_back(iovec{ buffer.data_, buffer.capacity_ });
+            }
+            m_registered = writeFixed
+                && syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_BUFFERS, iovecs.data(), static_cast<unsigned>(iovecs.size())) == 0;
+            if(!m_registered && !write)
+            {
+                throwErrno(EOPNOTSUPP, "io_uring cannot write files on this kernel");
+            }
+        }
+        catch(...)
+        {
+            // Leave the file open for the caller to fall back to another backend
+            unmapRings();
+            m_fd = -1;
+            throw;
+        }
+
+        for(auto & buffer : m_buffers)
+        {
+            m_free.push_back(&buffer);
+        }
+    }
+
+    ~IoUringWriter() override
+    {
+        closeQuietly();
+        unmapRings();
+    }
+
+    Buffer * acquire() override
+    {
+        checkError();
+        while(m_free.empty())
+        {
+            if(m_inFlight == 0)
+            {
+                throwAllHeld();
+            }
+            reap(true);
+            checkError();
+        }
+
+        Buffer * buffer = m_free.back();
+        m_free.pop_back();
+        return buffer;
+    }
+
+    const char * backendName() const override
+    {
+        return "io_uring";
+    }
+
+protected:
+    void startWrite(Buffer * buffer, off_t offset, std::size_t length) override
+    {
+        m_writes[buffer->index_] = Write{ offset, length };
+
+        // Never more writes in flight than buffers, and the ring has one entry per buffer, so it cannot be full
+        unsigned tail = *m_sqTail;
+        unsigned index = tail & *m_sqMask;
+
+        io_uring_sqe & sqe = static_cast<io_uring_sqe *>(m_sqes)[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = m_registered ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+        sqe.fd = m_fd;
+        sqe.addr = reinterpret_cast<std::uint64_t>(buffer->data_);
+        sqe.len = static_cast<std::uint32_t>(length);
+        sqe.off = static_cast<std::uint64_t>(offset);
+        sqe.buf_index = static_cast<std::uint16_t>(buffer->index_);
+        sqe.user_data = buffer->index_;
+
+        m_sqArray[index] = index;
+        __atomic_store_n(m_sqTail, tail + 1, __ATOMIC_RELEASE);
+        ++m_inFlight;
+
+        while(syscall(__NR_io_uring_enter, m_ringFd, 1, 0, 0, nullptr, 0) < 0)
+        {
+            if(errno != EINTR && errno != EAGAIN && errno != EBUSY)
+            {
+                // The kernel took nothing, so withdraw the entry, which waitAll() would otherwise wait for forever
+                const int error = errno;
+                __atomic_store_n(m_sqTail, tail, __ATOMIC_RELEASE);
+                --m_inFlight;
+                release(buffer);
+                m_error = m_error ? m_error : error;
+                throwErrno(error, "io_uring_enter failed");
+            }
+            reap(false);
+        }
+    }
+
+    void waitAll() override
+    {
+        while(m_inFlight > 0)
+        {
+            reap(true);
+        }
+    }
+
+    void release(Buffer * buffer) override
+    {
+        buffer->size_ = 0;
+        m_free.push_back(buffer);
+    }
+
+private:
+    struct Write
+    {
+        off_t offset_;
+        std::size_t length_;
+    };
+
+    void mapRings(const io_uring_params & params)
+    {
+        m_sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        m_cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if(singleMap)
+        {
+            m_sqRingSize = m_cqRingSize = std::max(m_sqRingSize, m_cqRingSize);
+        }
+
+        m_sqRing = mmap(nullptr, m_sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQ_RING);
+        if(m_sqRing == MAP_FAILED)
+        {
+            throwErrno(errno, "Mapping the io_uring submission ring failed");
+        }
+
+        m_cqRing = singleMap ? m_sqRing : mmap(nullptr, m_cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_CQ_RING);
+        if(m_cqRing == MAP_FAILED)
+        {
+            throwErrno(errno, "Mapping the io_uring completion ring failed");
+        }
+
+        m_sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        m_sqes = mmap(nullptr, m_sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_ringFd, IORING_OFF_SQES);
+        if(m_sqes == MAP_FAILED)
+        {
+            throwErrno(errno, "Mapping the io_uring submission entries failed");
+        }
+
+        auto sq = static_cast<char *>(m_sqRing);
+        m_sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        m_sqMask = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        m_sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+
+        auto cq = static_cast<char *>(m_cqRing);
+        m_cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        m_cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        m_cqMask = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        m_cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+    }
+
+    /* Whether the kernel supports each opcode, from IORING_REGISTER_PROBE
+       Kernels before 5.6 have no probe, and none of them has IORING_OP_WRITE, so all are reported unsupported */
+    std::vector<bool> supportedOps() const
+    {
+        constexpr unsigned opCount = 256;
+        std::vector<bool> supported(opCount, false);
+
+        std::vector<char> storage(sizeof(io_uring_probe) + opCount * sizeof(io_uring_probe_op), 0);
+        auto probe = reinterpret_cast<io_uring_probe *>(storage.data());
+        if(syscall(__NR_io_uring_register, m_ringFd, IORING_REGISTER_PROBE, probe, opCount) == 0)
+        {
+            for(unsigned op = 0; op < probe->ops_len && op < opCount; ++op)
+            {
+                supported[op] = (probe->ops[op].flags & IO_URING_OP_SUPPORTED) != 0;
+            }
+        }
+        return supported;
+    }
+
+    void unmapRings()
+    {
+        if(m_sqes != MAP_FAILED)
+        {
+            munmap(m_sqes, m_sqesSize);
+        }
+        if(m_cqRing != MAP_FAILED && m_cqRing != m_sqRing)
+        {
+            munmap(m_cqRing, m_cqRingSize);
+        }
+        if(m_sqRing != MAP_FAILED)
+        {
+            munmap(m_sqRing, m_sqRingSize);
+        }
+        if(m_ringFd >= 0)
+        {
+            ::close(m_ringFd);
+        }
+        m_sqes = m_cqRing = m_sqRing = MAP_FAILED;
+        m_ringFd = -1;
+    }
+
+    // Collect finished writes, optionally blocking until there is at least one
+    void reap(bool wait)
+    {
+        if(wait && m_inFlight > 0)
+        {
+            while(syscall(__NR_io_uring_enter, m_ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0)
+            {
+                if(errno != EINTR)
+                {
+                    throwErrno(errno, "io_uring_enter failed");
+                }
+            }
+        }
+
+        unsigned head = *m_cqHead;
+        unsigned tail = __atomic_load_n(m_cqTail, __ATOMIC_ACQUIRE);
+        for(; head != tail; ++head)
+        {
+            const io_uring_cqe & cqe = m_cqes[head & *m_cqMask];
+            Buffer & buffer = m_buffers[cqe.user_data];
+            const Write & write = m_writes[cqe.user_data];
+
+            if(cqe.res < 0)
+            {
+                m_error = m_error ? m_error : -cqe.res;
+            }
+            else if(static_cast<std::size_t>(cqe.res) < write.length_)
+            {
+                // Rare for regular files. Finish the remainder synchronously rather than queue another write
+                int error = writeFully(m_fd, buffer.data_ + cqe.res, write.length_ - cqe.res, write.offset_ + cqe.res);
+                m_error = m_error ? m_error : error;
+            }
+
+            --m_inFlight;
+            release(&buffer);
+        }
+        __atomic_store_n(m_cqHead, head, __ATOMIC_RELEASE);
+    }
+
+    int m_ringFd;
+    void * m_sqRing;
+    void * m_cqRing;
+    void * m_sqes;
+    std::size_t m_sqRingSize = 0;
+    std::size_t m_cqRingSize = 0;
+    std::size_t m_sqesSize = 0;
+
+    unsigned * m_sqTail = nullptr;
+    unsigned * m_sqMask = nullptr;
+    unsigned * m_sqArray = nullptr;
+    unsigned * m_cqHead = nullptr;
+    unsigned * m_cqTail = nullptr;
+    unsigned * m_cqMask = nullptr;
+    io_uring_cqe * m_cqes = nullptr;
+
+    bool m_registered;                      // Buffers are registered, so writes use IORING_OP_WRITE_FIXED
+    unsigned m_inFlight;
+    std::vector<Write> m_writes;            // Write in flight for each buffer, by buffer index
+    std::vector<Buffer *> m_free;
+};
+
+
+/* Fallback backend for kernels without io_uring, or where it is blocked
+   The indexes of submitted buffers pass to the writer thread through a single producer, single consumer queue, in
+   submission order whatever order they were acquired in. The thread takes every buffer submitted since it last looked
+   and writes them with a single pwritev, since their offsets are contiguous. */
+class PwritevWriter : public WriterBase
+{
+public:
+    PwritevWriter(int fd, bool directIO, const AsyncFileWriterOptions & options)
+        : WriterBase(fd, directIO, options)
+        , m_writes(m_buffers.size())
+        , m_queue(m_buffers.size())
+        , m_reclaimed(0)
+        , m_submitted(0)
+        , m_written(0)
+        , m_wakeups(0)
+        , m_stop(false)
+        , m_writeError(0)
+    {
+        for(auto & buffer : m_buffers)
+        {
+            m_free.push_back(&buffer);
+        }
+        m_thread = std::thread(&PwritevWriter::run, this);
+    }
+
+    ~PwritevWriter() override
+    {
+        closeQuietly();
+        stop();
+    }
+
+    Buffer * acquire() override
+    {
+        reclaim();
+        while(m_free.empty())
+        {
+            if(m_reclaimed == m_submitted.load(std::memory_order_relaxed))
+            {
+                throwAllHeld();
+            }
+            m_written.wait(m_reclaimed, std::memory_order_acquire);
+            reclaim();
+        }
+        takeWriteError();
+        checkError();
+
+        Buffer * buffer = m_free.back();
+        m_free.pop_back();
+        return buffer;
+    }
+
+    const char * backendName() const override
+    {
+        return "pwritev";
+    }
+
+protected:
+    void startWrite(Buffer * buffer, off_t offset, std::size_t length) override
+    {
+        m_writes[buffer->index_] = Write{ offset, length };
+
+        // Never more submitted and unwritten than buffers, so the slot was read by the writer thread long ago
+        const std::uint64_t submitted = m_submitted.load(std::memory_order_relaxed);
+        m_queue[submitted % m_queue.size()] = buffer->index_;
+        m_submitted.store(submitted + 1, std::memory_order_release);
+        wakeWriter();
+    }
+
+    void waitAll() override
+    {
+        const std::uint64_t submitted = m_submitted.load(std::memory_order_relaxed);
+        for(std::uint64_t written = m_written.load(std::memory_order_acquire); written != submitted; written = m_written.load(std::memory_order_acquire))
+        {
+            m_written.wait(written, std::memory_order_acquire);
+        }
+        takeWriteError();
+    }
+
+    void stop() override
+    {
+        m_stop.store(true, std::memory_order_release);
+        wakeWriter();
+        if(m_thread.joinable())
+        {
+            m_thread.join();
+        }
+    }
+
+    void release(Buffer * buffer) override
+    {
+        buffer->size_ = 0;
+        m_free.push_back(buffer);
+    }
+
+private:
+    struct Write
+    {
+        off_t offset_;
+        std::size_t length_;
+    };
+
+    void wakeWriter()
+    {
+        m_wakeups.fetch_add(1, std::memory_order_release);
+        m_wakeups.notify_one();
+    }
+
+    // Put the buffers the writer thread has finished with back in the pool
+    void reclaim()
+    {
+        const std::uint64_t written = m_written.load(std::memory_order_acquire);
+        for(; m_reclaimed < written; ++m_reclaimed)
+        {
+            Buffer & buffer = m_buffers[m_queue[m_reclaimed % m_queue.size()]];
+            buffer.size_ = 0;
+            m_free.push_back(&buffer);
+        }
+    }
+
+    // Move an error from the writer thread over to the producer, which reports it through checkError()
+    void takeWriteError()
+    {
+        if(m_error == 0)
+        {
+            m_error = m_writeError.load(std::memory_order_acquire);
+        }
+    }
+
+    void run()
+    {
+        const std::uint64_t count = m_buffers.size();
+        std::uint64_t written = 0;
+        std::vector<iovec> iovecs;
+
+        while(true)
+        {
+            unsigned wakeups = m_wakeups.load(std::memory_order_acquire);
+            std::uint64_t submitted = m_submitted.load(std::memory_order_acquire);
+            if(submitted == written)
+            {
+                if(m_stop.load(std::memory_order_acquire))
+                {
+                    return;
+                }
+                m_wakeups.wait(wakeups, std::memory_order_acquire);
+                continue;
+            }
+
+            std::uint64_t end = std::min<std::uint64_t>(submitted, written + IOV_MAX);
+            off_t offset = 0;
+            iovecs.clear();
+            for(std::uint64_t slot = written; slot < end; ++slot)
+            {
+                const unsigned index = m_queue[slot % count];
+                const Buffer & buffer = m_buffers[index];
+                const Write & write = m_writes[index];
+                if(iovecs.empty())
+                {
+                    offset = write.offset_;
+                }
+                iovecs.push_back(iovec{ buffer.data_, write.length_ });
+            }
+
+            int error = writeVector(iovecs, offset);
+            if(error != 0 && m_writeError.load(std::memory_order_relaxed) == 0)
+            {
+                m_writeError.store(error, std::memory_order_release);
+            }
+
+            written = end;
+            m_written.store(written, std::memory_order_release);
+            m_written.notify_all();
+        }
+    }
+
+    int writeVector(std::vector<iovec> & iovecs, off_t offset)
+    {
+        iovec * current = iovecs.data();
+        int remaining = static_cast<int>(iovecs.size());
+        while(remaining > 0)
+        {
+            ssize_t written = pwritev(m_fd, current, remaining, offset);
+            if(written < 0)
+            {
+                if(errno == EINTR)
+                {
+                    continue;
+                }
+                return errno;
+            }
+
+            // Skip what was written, which may end part way through a buffer
+            offset += written;
+            while(remaining > 0 && static_cast<std::size_t>(written) >= current->iov_len)
+            {
+                written -= static_cast<ssize_t>(current->iov_len);
+                ++current;
+                --remaining;
+            }
+            if(remaining > 0)
+            {
+                current->iov_base = static_cast<char *>(current->iov_base) + written;
+                current->iov_len -= static_cast<std::size_t>(written);
+            }
+        }
+        return 0;
+    }
+
+    std::vector<Write> m_writes;            // Write for each buffer, by buffer index
+    std::vector<unsigned> m_queue;          // Index of the buffer submitted in each slot, modulo the buffer count
+    std::vector<Buffer *> m_free;           // Only touched by the producer
+    std::uint64_t m_reclaimed;              // Slots whose buffers are back in m_free, only touched by the producer
+    std::atomic<std::uint64_t> m_submitted; // Buffers submitted by the producer
+    std::atomic<std::uint64_t> m_written;   // Buffers written by the writer thread
+    std::atomic<unsigned> m_wakeups;        // Bumped whenever the writer thread has something to look at
+    std::atomic<bool> m_stop;
+    std::atomic<int> m_writeError;          // First errno seen by the writer thread
+    std::thread m_thread;
+};
+
+} // end anonymous namespace
+
+std::unique_ptr<AsyncFileWriter> openAsyncFileWriter(const std::string & path, const AsyncFileWriterOptions & options)
+{
+    const int flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+
+    bool directIO = options.directIO_;
+    int fd = ::open(path.c_str(), flags | (directIO ? O_DIRECT : 0), 0644);
+    if(fd < 0 && directIO && errno == EINVAL)
+    {
+        // tmpfs and some others refuse O_DIRECT. Fall back to the page cache
+        directIO = false;
+        fd = ::open(path.c_str(), flags, 0644);
+    }
+    if(fd < 0)
+    {
+        throwErrno(errno, "Failed to open output file");
+    }
+
+    if(options.backend_ != AsyncFileWriterOptions::PWRITEV)
+    {
+        try
+        {
+            return std::make_unique<IoUringWriter>(fd, directIO, options);
+        }
+        catch(const std::system_error &)
+        {
+            if(options.backend_ == AsyncFileWriterOptions::IO_URING)
+            {
+                ::close(fd);
+                throw;
+            }
+        }
+    }
+    return std::make_unique<PwritevWriter>(fd, directIO, options);
+}
+
+AsyncFileSink::AsyncFileSink(AsyncFileWriter & writer)
+    : m_writer(writer)
+    , m_buffer(writer.acquire())
+{}
+
+AsyncFileSink::~AsyncFileSink()
+{
+    try
+    {
+        close();
+    }
+    catch(...)
+    {
+    }
+}
+
+void AsyncFileSink::appendSlow(std::string_view text)
+{
+    while(!text.empty())
+    {
+        std::size_t count = std::min(text.size(), m_buffer->capacity_ - m_buffer->size_);
+        std::char_traits<char>::copy(m_buffer->data_ + m_buffer->size_, text.data(), count);
+        m_buffer->size_ += count;
+        text.remove_prefix(count);
+
+        if(m_buffer->size_ == m_buffer->capacity_)
+        {
+            m_writer.submit(m_buffer);
+            m_buffer = m_writer.acquire();
+        }
+    }
+}
+
+void AsyncFileSink::flush()
+{
+    if(!m_buffer)
+    {
+        return;
+    }
+
+    // Direct I/O can only write whole blocks, so carry the partial block over into the next buffer
+    std::size_t length = m_buffer->size_;
+    if(m_writer.directIO())
+    {
+        length = length / AsyncFileWriter::BlockSize * AsyncFileWriter::BlockSize;
+    }
+
+    AsyncFileWriter::Buffer * next = m_writer.acquire();
+    std::char_traits<char>::copy(next->data_, m_buffer->data_ + length, m_buffer->size_ - length);
+    next->size_ = m_buffer->size_ - length;
+
+    m_buffer->size_ = length;
+    m_writer.submit(m_buffer);
+    m_buffer = next;
+
+    m_writer.flush();
+}
+
+void AsyncFileSink::close()
+{
+    if(!m_buffer)
+    {
+        return;
+    }
+
+    AsyncFileWriter::Buffer * last = m_buffer;
+    m_buffer = nullptr;
+    m_writer.close(last);
+}
+
+} // end namespace commonlib
@@ -0,0 +1,147 @@
+#include "commonlib/Clock.hpp"
+
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__x86_64__)
+#include <cpuid.h>
+#endif
+
+
+namespace commonlib
+{
+
+namespace
+{
+
+// How long the constructor watches the counter against steady_clock for a first rate
+constexpr auto s_calibration = std::chrono::milliseconds(10);
+
+struct ClockSample
+{
+    std::uint64_t tsc_;
+    std::chrono::steady_clock::time_point steady_;
+    std::int64_t systemNanoseconds_;
+};
+
+std::int64_t nanosecondsSinceEpoch(std::chrono::system_clock::time_point timestamp)
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(timestamp.time_since_epoch()).count();
+}
+
+/* Both clocks with the counter read either side, taking the midpoint
+   The narrowest of a few tries is kept, so a sample straddling an interrupt does not skew the rate or the base */
+ClockSample sampleClocks(const TscClock::WallClock & wallClock, const TscClock::Counter & readCounter)
+{
+    ClockSample best{};
+    std::uint64_t bestWindow = std::numeric_limits<std::uint64_t>::max();
+    for(int i = 0; i < 5; ++i)
+    {
+        const std::uint64_t before = readCounter();
+        const auto steady = std::chrono::steady_clock::now();
+        const auto system = wallClock();
+        const std::uint64_t after = readCounter();
+        if(after - before < bestWindow)
+        {
+            bestWindow = after - before;
+            best = ClockSample{ before + (after - before) / 2, steady, nanosecondsSinceEpoch(system) };
+        }
+    }
+    return best;
+}
+
+} // end anonymous namespace
+
+bool TscClock::supported()
+{
+#if defined(__x86_64__)
+    // Invariant TSC: ticks at a constant rate whatever the power state, CPUID.80000007H:EDX bit 8
+    unsigned eax, ebx, ecx, edx;
+    return __get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx) && (edx & (1u << 8)) != 0;
+#else
+    return false;
+#endif
+}
+
+TscClock::TscClock(std::chrono::nanoseconds resyncInterval)
+    : TscClock(resyncInterval, [] { return std::chrono::system_clock::now(); })
+{}
+
+TscClock::TscClock(std::chrono::nanoseconds resyncInterval, WallClock wallClock, Counter counter)
+    : m_wallClock(std::move(wallClock))
+    , m_counter(std::move(counter))
+{
+    if(!m_counter && !supported())
+    {
+        throw std::runtime_error("No invariant TSC to build a clock on");
+    }
+    if(resyncInterval <= std::chrono::nanoseconds::zero())
+    {
+        throw std::invalid_argument("TSC clock resync interval must be positive");
+    }
+
+    const ClockSample start = sampleClocks(m_wallClock, [this] { return readCounter(); });
+    std::this_thread::sleep_for(s_calibration);
+    const ClockSample end = sampleClocks(m_wallClock, [this] { return readCounter(); });
+
+    m_calibrationTsc = start.tsc_;
+    m_calibrationSteady = start.steady_;
+    m_nanosecondsPerTick = static_cast<double>(std::chrono::nanoseconds(end.steady_ - start.steady_).count())
+                         / static_cast<double>(end.tsc_ - start.tsc_);
+    m_resyncTicks = static_cast<std::uint64_t>(static_cast<double>(resyncInterval.count()) / m_nanosecondsPerTick);
+    m_baseTsc = end.tsc_;
+    m_baseNanoseconds = end.systemNanoseconds_;
+    m_floorNanoseconds = std::numeric_limits<std::int64_t>::min();
+    m_resyncAt = m_baseTsc + m_resyncTicks;
+}
+
+void TscClock::resync()
+{
+    const ClockSample sample = sampleClocks(m_wallClock, [this] { return readCounter(); });
+
+    /* The old extrapolation at this instant is the most any stamp since the last resync can have been. The floor
+       from before that may be later still, if the wall time was put back by more than an interval */
+    m_floorNanoseconds = std::max(m_floorNanoseconds,
+                                  m_baseNanoseconds + static_cast<std::int64_t>(static_cast<double>(sample.tsc_ - m_baseTsc) * m_nanosecondsPerTick));
+
+    // steady_clock is slewed but never stepped, so the rate over the whole run is the best estimate
+    const double resyncInterval = static_cast<double>(m_resyncTicks) * m_nanosecondsPerTick;
+    m_nanosecondsPerTick = static_cast<double>(std::chrono::nanoseconds(sample.steady_ - m_calibrationSteady).count())
+                         / static_cast<double>(sample.tsc_ - m_calibrationTsc);
+    m_resyncTicks = static_cast<std::uint64_t>(resyncInterval / m_nanosecondsPerTick);
+
+    m_baseTsc = sample.tsc_;
+    m_baseNanoseconds = sample.systemNanoseconds_;
+    m_resyncAt = m_baseTsc + m_resyncTicks;
+}
+
+CoarseClock::CoarseClock(std::chrono::microseconds resolution)
+    : m_now(std::chrono::system_clock::now().time_since_epoch().count())
+    , m_stop(false)
+{
+    if(resolution <= std::chrono::microseconds::zero())
+    {
+        throw std::invalid_argument("Coarse clock resolution must be positive");
+    }
+    m_updater = std::thread(&CoarseClock::update, this, resolution);
+}
+
+CoarseClock::~CoarseClock()
+{
+    m_stop.store(true, std::memory_order_relaxed);
+    m_updater.join();
+}
+
+void CoarseClock::update(std::chrono::microseconds resolution)
+{
+    while(!m_stop.load(std::memory_order_relaxed))
+    {
+        std::this_thread::sleep_for(resolution);
+        // The only writer, so a plain load and store is enough to keep it from going backwards
+        const auto now = std::chrono::system_clock::now().time_since_epoch().count();
+        m_now.store(std::max(now, m_now.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+    }
+}
+
+} // end namespace commonlib
@@ -0,0 +1,151 @@
+#include "commonlib/DedupFilter.hpp"
+
+#include "commonlib/Hash.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <stdexcept>
+
+
+namespace commonlib
+{
+
+namespace
+{
+
+constexpr std::size_t s_bitsPerBlock = 512;
+
+// Keeping all of a fingerprint's bits in one block raises the false positive rate, so give it this many more bits
+constexpr double s_blockingOverhead = 1.2;
+
+} // end anonymous namespace
+
+DedupFilter::DedupFilter(const DedupFilterOptions & options)
+    : m_window(options.window_)
+    , m_current(0)
+    , m_rotateAt(std::chrono::steady_clock::duration::min().count())
+{
+    if(options.falsePositiveRate_ <= 0.0 || options.falsePositiveRate_ >= 1.0)
+    {
+        throw std::invalid_argument("False positive rate must be between 0 and 1");
+    }
+    if(m_window <= std::chrono::steady_clock::duration::zero())
+    {
+        throw std::invalid_argument("Dedup window must be positive");
+    }
+
+    // Both generations are checked, so each gets half the false positive budget
+    const double ln2 = std::log(2.0);
+    double bitsPerEvent = -std::log(options.falsePositiveRate_ / 2.0) / (ln2 * ln2) * s_blockingOverhead;
+    m_hashes = std::clamp(static_cast<int>(std::lround(bitsPerEvent / s_blockingOverhead * ln2)), 1, 16);
+
+    double bits = bitsPerEvent * static_cast<double>(std::max<std::size_t>(options.expectedEventsPerWindow_, 1));
+    m_blocks = std::max<std::size_t>(static_cast<std::size_t>(std::ceil(bits / s_bitsPerBlock)), 1);
+
+    for(auto & generation : m_generations)
+    {
+        generation = std::make_unique<Block[]>(m_blocks);
+        for(std::size_t i = 0; i < m_blocks; ++i)
+        {
+            for(auto & word : generation[i].words_)
+            {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+std::size_t DedupFilter::memoryBytes() const
+{
+    return 2 * m_blocks * sizeof(Block);
+}
+
+void DedupFilter::rotate(std::chrono::steady_clock::time_point now)
+{
+    std::lock_guard<std::mutex> lock(m_rotateMutex);
+    if(now.time_since_epoch().count() < m_rotateAt.load(std::memory_order_acquire))
+    {
+        return;                                 // Another thread got here first
+    }
+
+    auto clear = [this](int generation)
+    {
+        Block * blocks = m_generations[generation].get();
+        for(std::size_t i = 0; i < m_blocks; ++i)
+        {
+            for(auto & word : blocks[i].words_)
+            {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    // The previous generation has aged out. Clear it and make it current. After a quiet spell of more than a window
+    // the current generation has aged out too
+    int current = m_current.load(std::memory_order_relaxed);
+    int next = 1 - current;
+    clear(next);
+    if(now.time_since_epoch() - m_window >= std::chrono::steady_clock::duration(m_rotateAt.load(std::memory_order_relaxed)))
+    {
+        clear(current);
+    }
+
+    m_current.store(next, std::memory_order_release);
+    m_rotateAt.store((now + m_window).time_since_epoch().count(), std::memory_order_release);
+}
+
+bool DedupFilter::admit(std::uint64_t fingerprint, std::chrono::steady_clock::time_point now)
+{
+    if(now.time_since_epoch().count() >= m_rotateAt.load(std::memory_order_acquire))
+    {
+        rotate(now);
+    }
+
+    /* Pick the block from the high half of the product, and the bits within it from nine bit slices of a second hash
+       A hash has seven whole slices, so each further seven come from a fresh hash of the first, not a rehash of
+       what is left of the last */
+    std::uint64_t hash = mixHash(fingerprint);
+    auto block = static_cast<std::size_t>((static_cast<unsigned __int128>(hash) * m_blocks) >> 64);
+    std::uint64_t bits = mixHash(hash + 0x9e3779b97f4a7c15ULL);
+
+    std::array<std::uint64_t, WordsPerBlock> masks = {};
+    for(int i = 0; i < m_hashes; ++i)
+    {
+        auto bit = static_cast<unsigned>(bits & (s_bitsPerBlock - 1));
+        masks[bit / 64] |= std::uint64_t(1) << (bit % 64);
+        bits = (i % 7 == 6) ? mixHash(hash + static_cast<std::uint64_t>(i / 7 + 2) * 0x9e3779b97f4a7c15ULL) : bits >> 9;
+    }
+
+    auto contains = [&masks](const Block & candidate)
+    {
+        for(std::size_t word = 0; word < WordsPerBlock; ++word)
+        {
+            if((candidate.words_[word].load(std::memory_order_relaxed) & masks[word]) != masks[word])
+            {
+                return false;
+            }
+        }
+        return true;
+    };
+
+    int current = m_current.load(std::memory_order_acquire);
+    Block & currentBlock = m_generations[current][block];
+    if(contains(currentBlock))
+    {
+        return false;
+    }
+
+    // Seen only in the previous generation still counts as a duplicate, but is carried forward so it stays remembered
+    bool seen = contains(m_generations[1 - current][block]);
+    for(std::size_t word = 0; word < WordsPerBlock; ++word)
+    {
+        if(masks[word])
+        {
+            currentBlock.words_[word].fetch_or(masks[word], std::memory_order_relaxed);
+        }
+    }
+    return !seen;
+}
+
+} // end namespace commonlib
@@ -0,0 +1,75 @@
+#include "commonlib/Json.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+namespace commonlib
+{
+
+#if !defined(__SSE2__)
+namespace
+{
+
+bool needsEscape(unsigned char byte)
+{
+    return byte < 0x20 || byte == '"' || byte == '\\';
+}
+
+} // end anonymous namespace
+#endif
+
+std::size_t jsonCleanPrefix(std::string_view text)
+{
+    const char * data = text.data();
+    const std::size_t size = text.size();
+
+#if defined(__SSE2__)
+    // Offset of the first byte needing an escape in 16 bytes at block, or 16 if there is none
+    auto scan = [](const char * block)
+    {
+        const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block));
+        const __m128i lastControl = _mm_set1_epi8(0x1f);
+        // Unsigned byte <= 0x1f exactly when max(byte, 0x1f) == 0x1f
+        const __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(bytes, lastControl), lastControl);
+        const __m128i quote = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('"'));
+        const __m128i backslash = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\\'));
+        const auto mask = static_cast<unsigned>(_mm_movemask_epi8(_mm_or_si128(control, _mm_or_si128(quote, backslash))));
+        return mask == 0 ? std::size_t(16) : static_cast<std::size_t>(__builtin_ctz(mask));
+    };
+
+    std::size_t offset = 0;
+    for(; offset + 16 <= size; offset += 16)
+    {
+        const std::size_t special = scan(data + offset);
+        if(special != 16)
+        {
+            return offset + special;
+        }
+    }
+
+    if(offset == size)
+    {
+        return size;
+    }
+
+    // Most ids are shorter than a vector. Pad the tail with spaces, which need no escape, rather than loop over it
+    char tail[16];
+    std::memset(tail, ' ', sizeof(tail));
+    std::memcpy(tail, data + offset, size - offset);
+    return offset + std::min(scan(tail), size - offset);
+#else
+    std::size_t offset = 0;
+    while(offset < size && !needsEscape(static_cast<unsigned char>(data[offset])))
+    {
+        ++offset;
+    }
+    return offset;
+#endif
+}
+
+} // end namespace commonlib
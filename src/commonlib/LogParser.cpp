@@ -0,0 +1,295 @@
+#include "commonlib/LogParser.hpp"
+
+#include "commonlib/Timestamp.hpp"
+
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+
+namespace commonlib
+{
+
+namespace
+{
+
+struct DataLabel
+{
+    std::string_view label_;
+    EventKind kind_;
+};
+
+// The specific data line of each type, as each library writes it
+constexpr DataLabel s_dataLabels[] =
+{
+    // classiclib
+    { "Some specific data for session start: ", EventKind::SESSION_START },
+    { "Some specific data for session end: ",   EventKind::SESSION_END },
+    { "Some specific data for auth login: ",    EventKind::AUTH_LOGIN },
+    { "Some specific data for auth logout: ",   EventKind::AUTH_LOGOUT },
+    // purecomplib
+    { "Some specific data for SessionStartEvent: ", EventKind::SESSION_START },
+    { "Some specific data for SessionEndEvent: ",   EventKind::SESSION_END },
+    { "Some specific data for AuthLoginEvent: ",    EventKind::AUTH_LOGIN },
+    { "Some specific data for AuthLogoutEvent: ",   EventKind::AUTH_LOGOUT },
+    // templatecastlib
+    { "Specific data for session start event: ", EventKind::SESSION_START },
+    { "Specific data for session end event: ",   EventKind::SESSION_END },
+    { "Specific data for auth login event: ",    EventKind::AUTH_LOGIN },
+    { "Specific data for auth logout event: ",   EventKind::AUTH_LOGOUT },
+};
+
+constexpr std::string_view s_pidPrefix = "PID is ";
+constexpr std::string_view s_timestampPrefix = "Timestamp is ";
+constexpr std::string_view s_sessionPrefix = "Session id is ";
+constexpr std::string_view s_userPrefix = "User is ";
+constexpr std::string_view s_weightPrefix = "Sample weight is ";
+
+// Parse all of text as a number
+template <class T>
+bool parseNumber(std::string_view text, T & value)
+{
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    return result.ec == std::errc() && result.ptr == text.data() + text.size();
+}
+
+bool isSessionKind(EventKind kind)
+{
+    return kind == EventKind::SESSION_START || kind == EventKind::SESSION_END;
+}
+
+std::uint64_t newlinesScalar(const char * block)
+{
+    std::uint64_t mask = 0;
+    for(std::size_t i = 0; i < 64; ++i)
+    {
+        mask |= static_cast<std::uint64_t>(block[i] == '\n') << i;
+    }
+    return mask;
+}
+
+#if defined(__x86_64__)
+std::uint64_t newlinesSse2(const char * block)
+{
+    const __m128i newline = _mm_set1_epi8('\n');
+    std::uint64_t mask = 0;
+    for(int i = 0; i < 4; ++i)
+    {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(block + 16 * i));
+        mask |= static_cast<std::uint64_t>(static_cast<std::uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, newline)))) << (16 * i);
+    }
+    return mask;
+}
+
+// Built for AVX2 whatever the compiler flags, and only called when the CPU has it
+__attribute__((target("avx2")))
+std::uint64_t newlinesAvx2(const char * block)
+{
+    const __m256i newline = _mm256_set1_epi8('\n');
+    __m256i low = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block));
+    __m256i high = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(block + 32));
+    auto lowMask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(low, newline)));
+    auto highMask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(high, newline)));
+    return lowMask | (static_cast<std::uint64_t>(highMask) << 32);
+}
+#endif
+
+} // end anonymous namespace
+
+bool LogParser::supported(Scan scan)
+{
+    switch(scan)
+    {
+        case AUTO:
+        case SCALAR:
+            return true;
+#if defined(__x86_64__)
+        case SSE2:
+            return true;                    // Part of x86-64
+        case AVX2:
+            return __builtin_cpu_supports("avx2");
+#endif
+        default:
+            return false;
+    }
+}
+
+LogParser::LogParser(std::string_view text, Scan scan)
+    : m_text(text)
+    , m_scan(newlinesScalar)
+    , m_blockStart(0)
+    , m_nextBlock(0)
+    , m_newlines(0)
+    , m_lineStart(0)
+    , m_hasPending(false)
+    , m_malformed(0)
+{
+    if(!supported(scan))
+    {
+        throw std::invalid_argument("Requested SIMD scan is not supported on this CPU");
+    }
+
+#if defined(__x86_64__)
+    if(scan == AVX2 || (scan == AUTO && supported(AVX2)))
+    {
+        m_scan = newlinesAvx2;
+    }
+    else if(scan == SSE2 || scan == AUTO)
+    {
+        m_scan = newlinesSse2;
+    }
+#endif
+}
+
+bool LogParser::nextLine(std::string_view & line)
+{
+    if(m_hasPending)
+    {
+        line = m_pending;
+        m_hasPending = false;
+        return true;
+    }
+
+    while(m_newlines == 0)
+    {
+        if(m_nextBlock >= m_text.size())
+        {
+            // A last line without a newline
+            if(m_lineStart < m_text.size())
+            {
+                line = m_text.substr(m_lineStart);
+                m_lineStart = m_text.size();
+                return true;
+            }
+            return false;
+        }
+
+        const char * block = m_text.data() + m_nextBlock;
+        const std::size_t remaining = m_text.size() - m_nextBlock;
+        if(remaining >= BlockSize)
+        {
+            m_newlines = m_scan(block);
+        }
+        else
+        {
+            // Never read past the end of the text, which may be the end of a mapping
+            char tail[BlockSize] = {};
+            std::memcpy(tail, block, remaining);
+            m_newlines = m_scan(tail);
+        }
+        m_blockStart = m_nextBlock;
+        m_nextBlock += BlockSize;
+    }
+
+    const std::size_t end = m_blockStart + static_cast<std::size_t>(__builtin_ctzll(m_newlines));
+    m_newlines &= m_newlines - 1;
+    line = m_text.substr(m_lineStart, end - m_lineStart);
+    m_lineStart = end + 1;
+    return true;
+}
+
+bool LogParser::next(ParsedEvent & event)
+{
+    std::string_view line;
+    while(nextLine(line))
+    {
+        if(line.starts_with(s_pidPrefix) && parseRecord(line, event))
+        {
+            return true;
+        }
+        ++m_malformed;
+    }
+    return false;
+}
+
+bool LogParser::parseRecord(std::string_view pidLine, ParsedEvent & event)
+{
+    if(!parseNumber(pidLine.substr(s_pidPrefix.size()), event.pid_))
+    {
+        return false;
+    }
+
+    // Any line that fails to parse may be the start of the next record, so give it back
+    std::string_view line;
+    auto giveBack = [this, &line]
+    {
+        m_pending = line;
+        m_hasPending = true;
+        return false;
+    };
+
+    if(!nextLine(line))
+    {
+        return false;
+    }
+    // templatecastlib used to write the PID line twice, so logs from before the fix have it repeated
+    if(line == pidLine && !nextLine(line))
+    {
+        return false;
+    }
+    if(!line.starts_with(s_timestampPrefix) || !parseLocalTimestamp(line.substr(s_timestampPrefix.size()), event.timestamp_))
+    {
+        return giveBack();
+    }
+
+    if(!nextLine(line))
+    {
+        return false;
+    }
+    bool session;
+    if(line.starts_with(s_sessionPrefix))
+    {
+        session = true;
+        event.id_ = line.substr(s_sessionPrefix.size());
+    }
+    else if(line.starts_with(s_userPrefix))
+    {
+        session = false;
+        event.id_ = line.substr(s_userPrefix.size());
+    }
+    else
+    {
+        return giveBack();
+    }
+
+    if(!nextLine(line))
+    {
+        return false;
+    }
+    const DataLabel * label = nullptr;
+    for(const auto & candidate : s_dataLabels)
+    {
+        if(line.starts_with(candidate.label_))
+        {
+            label = &candidate;
+            break;
+        }
+    }
+    if(!label || isSessionKind(label->kind_) != session
+       || !parseNumber(line.substr(label->label_.size()), event.someSpecificData_))
+    {
+        return giveBack();
+    }
+    event.kind_ = label->kind_;
+
+    event.weight_ = 1.0;
+    if(nextLine(line))
+    {
+        double weight;
+        if(line.starts_with(s_weightPrefix) && parseNumber(line.substr(s_weightPrefix.size()), weight))
+        {
+            event.weight_ = weight;
+        }
+        else
+        {
+            giveBack();
+        }
+    }
+    return true;
+}
+
+} // end namespace commonlib
@@ -0,0 +1,59 @@
+#include "commonlib/MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <system_error>
+
+
+namespace commonlib
+{
+
+MappedFile::MappedFile(const std::string & path)
+    : m_data(nullptr)
+    , m_size(0)
+{
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "Failed to open " + path);
+    }
+
+    struct stat status;
+    if(::fstat(fd, &status) != 0)
+    {
+        int error = errno;
+        ::close(fd);
+        throw std::system_error(error, std::generic_category(), "Failed to stat " + path);
+    }
+
+    m_size = static_cast<std::size_t>(status.st_size);
+    if(m_size > 0)
+    {
+        void * data = ::mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED)
+        {
+            int error = errno;
+            ::close(fd);
+            throw std::system_error(error, std::generic_category(), "Failed to map " + path);
+        }
+        ::madvise(data, m_size, MADV_SEQUENTIAL);
+        m_data = static_cast<const char *>(data);
+    }
+
+    // The mapping keeps the file alive
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if(m_data)
+    {
+        ::munmap(const_cast<char *>(m_data), m_size);
+    }
+}
+
+} // end namespace commonlib
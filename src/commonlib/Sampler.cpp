@@ -0,0 +1,95 @@
+#include "commonlib/Sampler.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace commonlib
+{
+
+namespace
+{
+
+constexpr double s_keyRange = 4294967296.0;             // 2^32, the number of distinct sampling keys
+
+// Weight of the new interval's rate against the smoothed one, so one bursty interval does not swing the rate
+constexpr double s_smoothing = 0.5;
+
+} // end anonymous namespace
+
+Sampler::Sampler(const std::array<SamplingPolicy, EventKindCount> & policies, std::chrono::steady_clock::time_point now)
+    : m_updatedAt(now)
+{
+    for(std::size_t kind = 0; kind < EventKindCount; ++kind)
+    {
+        const auto & policy = policies[kind];
+        auto & state = m_kinds[kind];
+        state.policy_ = policy;
+
+        switch(policy.mode_)
+        {
+            case SamplingPolicy::KEEP_ALL:
+                setRate(state, 1.0);
+                break;
+            case SamplingPolicy::FIXED:
+                if(policy.rate_ <= 0.0 || policy.rate_ > 1.0)
+                {
+                    throw std::invalid_argument("Fixed sampling rate must be in (0, 1]");
+                }
+                setRate(state, policy.rate_);
+                break;
+            case SamplingPolicy::ADAPTIVE:
+                if(policy.targetPerSecond_ <= 0.0 || policy.minRate_ <= 0.0 || policy.minRate_ > 1.0)
+                {
+                    throw std::invalid_argument("Adaptive sampling needs a positive target and a minimum rate in (0, 1]");
+                }
+                // Keep everything until there is a rate to go on
+                setRate(state, 1.0);
+                break;
+            default:
+                throw std::invalid_argument("Unknown sampling mode");
+        }
+    }
+}
+
+void Sampler::update(std::chrono::steady_clock::time_point now)
+{
+    const double elapsed = std::chrono::duration<double>(now - m_updatedAt).count();
+    if(elapsed <= 0.0)
+    {
+        return;
+    }
+    m_updatedAt = now;
+
+    for(auto & state : m_kinds)
+    {
+        const double offered = static_cast<double>(state.offered_ - state.offeredAtUpdate_);
+        state.offeredAtUpdate_ = state.offered_;
+        if(state.policy_.mode_ != SamplingPolicy::ADAPTIVE)
+        {
+            continue;
+        }
+
+        const double observed = offered / elapsed;
+        state.observedPerSecond_ = state.observedPerSecond_ == 0.0
+            ? observed
+            : s_smoothing * observed + (1.0 - s_smoothing) * state.observedPerSecond_;
+
+        const double rate = state.observedPerSecond_ > 0.0 ? state.policy_.targetPerSecond_ / state.observedPerSecond_ : 1.0;
+        setRate(state, std::clamp(rate, state.policy_.minRate_, 1.0));
+    }
+}
+
+double Sampler::rate(EventKind kind) const
+{
+    return static_cast<double>(m_kinds[kindIndex(kind)].threshold_) / s_keyRange;
+}
+
+void Sampler::setRate(KindState & state, double rate)
+{
+    state.threshold_ = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(rate * s_keyRange));
+    // The weight is taken from the threshold actually used, so it matches the fraction of keys kept
+    state.weight_ = s_keyRange / static_cast<double>(state.threshold_);
+}
+
+} // end namespace commonlib
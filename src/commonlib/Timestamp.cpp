@@ -0,0 +1,146 @@
+#include "commonlib/Timestamp.hpp"
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+
+
+namespace commonlib
+{
+
+namespace
+{
+
+struct TimestampCache
+{
+    std::time_t seconds_;                           // Second last formatted
+    bool valid_;                                    // False until the first call on this thread
+    std::size_t length_;                            // Length of text_
+    char text_[32];                                 // Formatted text of seconds_
+};
+
+thread_local TimestampCache t_cache = {};
+thread_local TimestampCache t_isoCache = {};
+
+struct OffsetCache
+{
+    std::int64_t localHour_;                        // Hours since the epoch in local time
+    bool valid_;
+    std::int64_t offset_;                           // UTC minus local time, in seconds, during localHour_
+};
+
+thread_local OffsetCache t_offsetCache = {};
+
+// Value of the digits in text[begin, begin + count), or -1 if any is not a digit
+int parseDigits(std::string_view text, std::size_t begin, std::size_t count)
+{
+    int value = 0;
+    for(std::size_t i = begin; i < begin + count; ++i)
+    {
+        unsigned digit = static_cast<unsigned char>(text[i]) - '0';
+        if(digit > 9)
+        {
+            return -1;
+        }
+        value = value * 10 + static_cast<int>(digit);
+    }
+    return value;
+}
+
+} // end anonymous namespace
+
+std::string_view formatLocalTimestamp(std::chrono::system_clock::time_point timestamp)
+{
+    std::time_t seconds = std::chrono::system_clock::to_time_t(timestamp);
+    if(!t_cache.valid_ || t_cache.seconds_ != seconds)
+    {
+        std::tm tm;
+        localtime_r(&seconds, &tm);                 // Convert to local time
+        t_cache.length_ = std::strftime(t_cache.text_, sizeof(t_cache.text_), "%Y-%m-%d %H:%M:%S", &tm);
+        t_cache.seconds_ = seconds;
+        t_cache.valid_ = true;
+    }
+    return std::string_view(t_cache.text_, t_cache.length_);
+}
+
+std::string_view formatIsoTimestamp(std::chrono::system_clock::time_point timestamp)
+{
+    using namespace std::chrono;
+
+    const auto seconds = floor<std::chrono::seconds>(timestamp);
+    if(!t_isoCache.valid_ || t_isoCache.seconds_ != static_cast<std::time_t>(seconds.time_since_epoch().count()))
+    {
+        const auto day = floor<days>(seconds);
+        const year_month_day date(day);
+        const hh_mm_ss<std::chrono::seconds> time(seconds - day);
+
+        // Everything up to the decimal point, which is all that changes once a second
+        int length = std::snprintf(t_isoCache.text_, sizeof(t_isoCache.text_), "%04d-%02u-%02uT%02d:%02d:%02d.",
+                                   static_cast<int>(date.year()), static_cast<unsigned>(date.month()), static_cast<unsigned>(date.day()),
+                                   static_cast<int>(time.hours().count()), static_cast<int>(time.minutes().count()), static_cast<int>(time.seconds().count()));
+        t_isoCache.length_ = static_cast<std::size_t>(length);
+        t_isoCache.seconds_ = static_cast<std::time_t>(seconds.time_since_epoch().count());
+        t_isoCache.valid_ = true;
+    }
+
+    auto micros = static_cast<unsigned>(duration_cast<microseconds>(timestamp - seconds).count());
+    char * fraction = t_isoCache.text_ + t_isoCache.length_;
+    for(int digit = 5; digit >= 0; --digit)
+    {
+        fraction[digit] = static_cast<char>('0' + micros % 10);
+        micros /= 10;
+    }
+    fraction[6] = 'Z';
+    return std::string_view(t_isoCache.text_, t_isoCache.length_ + 7);
+}
+
+bool parseLocalTimestamp(std::string_view text, std::chrono::system_clock::time_point & timestamp)
+{
+    // 0123456789012345678
+    // YYYY-MM-DD HH:MM:SS
+    if(text.size() != 19 || text[4] != '-' || text[7] != '-' || text[10] != ' ' || text[13] != ':' || text[16] != ':')
+    {
+        return false;
+    }
+
+    const int year = parseDigits(text, 0, 4);
+    const int month = parseDigits(text, 5, 2);
+    const int day = parseDigits(text, 8, 2);
+    const int hour = parseDigits(text, 11, 2);
+    const int minute = parseDigits(text, 14, 2);
+    const int second = parseDigits(text, 17, 2);
+    if(year < 0 || month < 0 || day < 0 || hour < 0 || hour > 23 || minute < 0 || minute > 59 || second < 0 || second > 60)
+    {
+        return false;
+    }
+
+    const std::chrono::year_month_day date{ std::chrono::year(year), std::chrono::month(static_cast<unsigned>(month)), std::chrono::day(static_cast<unsigned>(day)) };
+    if(!date.ok())
+    {
+        return false;
+    }
+
+    const std::int64_t localHour = static_cast<std::int64_t>(std::chrono::sys_days(date).time_since_epoch().count()) * 24 + hour;
+    if(!t_offsetCache.valid_ || t_offsetCache.localHour_ != localHour)
+    {
+        std::tm tm = {};
+        tm.tm_year = year - 1900;
+        tm.tm_mon = month - 1;
+        tm.tm_mday = day;
+        tm.tm_hour = hour;
+        tm.tm_isdst = -1;                           // Let the time zone rules decide
+        const std::time_t utc = std::mktime(&tm);
+        if(utc == static_cast<std::time_t>(-1))
+        {
+            return false;
+        }
+        t_offsetCache.localHour_ = localHour;
+        t_offsetCache.offset_ = static_cast<std::int64_t>(utc) - localHour * 3600;
+        t_offsetCache.valid_ = true;
+    }
+
+    timestamp = std::chrono::system_clock::time_point(std::chrono::seconds(localHour * 3600 + minute * 60 + second + t_offsetCache.offset_));
+    return true;
+}
+
+} // end namespace commonlib
@@ -0,0 +1,94 @@
+#include "LatencyHistogram.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+
+namespace loadgen
+{
+
+namespace
+{
+
+constexpr std::uint64_t s_subBuckets = std::uint64_t(1) << LatencyHistogram::SubBucketBits;
+
+// The exact buckets, then half as many for each magnitude up to the top bit of a 64 bit value
+constexpr std::size_t s_buckets = s_subBuckets + (64 - LatencyHistogram::SubBucketBits) * (s_subBuckets / 2);
+
+} // end anonymous namespace
+
+LatencyHistogram::LatencyHistogram()
+    : m_counts(s_buckets, 0)
+    , m_count(0)
+    , m_max(0)
+{}
+
+std::size_t LatencyHistogram::bucketIndex(std::uint64_t value)
+{
+    // Values below s_subBuckets get a bucket each, above that each doubling gets s_subBuckets / 2 buckets
+    if(value < s_subBuckets)
+    {
+        return static_cast<std::size_t>(value);
+    }
+    int magnitude = std::bit_width(value) - SubBucketBits;            // At least 1
+    std::uint64_t subBucket = (value >> magnitude) - s_subBuckets / 2;  // Top bits below the leading one
+    return static_cast<std::size_t>(s_subBuckets + (magnitude - 1) * (s_subBuckets / 2) + subBucket);
+}
+
+std::uint64_t LatencyHistogram::bucketUpperBound(std::size_t index)
+{
+    if(index < s_subBuckets)
+    {
+        return index;
+    }
+    std::size_t magnitude = (index - s_subBuckets) / (s_subBuckets / 2) + 1;
+    std::uint64_t subBucket = (index - s_subBuckets) % (s_subBuckets / 2) + s_subBuckets / 2;
+    return ((subBucket + 1) << magnitude) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t nanoseconds)
+{
+    ++m_counts[bucketIndex(nanoseconds)];
+    ++m_count;
+    m_max = std::max(m_max, nanoseconds);
+}
+
+void LatencyHistogram::reset()
+{
+    std::fill(m_counts.begin(), m_counts.end(), 0);
+    m_count = 0;
+    m_max = 0;
+}
+
+std::uint64_t LatencyHistogram::percentile(double fraction) const
+{
+    if(m_count == 0)
+    {
+        return 0;
+    }
+
+    // The number of values that must be at or below, rounded up. Less a hair, so 0.07 of 100 is 7 rather than 8
+    auto target = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(m_count) - 1e-9));
+    target = std::clamp<std::uint64_t>(target, 1, m_count);
+
+    std::uint64_t seen = 0;
+    for(std::size_t i = 0; i < m_counts.size(); ++i)
+    {
+        seen += m_counts[i];
+        if(seen >= target)
+        {
+            return std::min(bucketUpperBound(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+void recordDispatch(LatencyHistogram & corrected, LatencyHistogram & uncorrected, std::chrono::steady_clock::time_point due,
+                    std::chrono::steady_clock::time_point sent, std::chrono::steady_clock::time_point done)
+{
+    corrected.record(static_cast<std::uint64_t>(std::chrono::nanoseconds(done - due).count()));
+    uncorrected.record(static_cast<std::uint64_t>(std::chrono::nanoseconds(done - sent).count()));
+}
+
+} // end namespace loadgen
@@ -0,0 +1,48 @@
+#ifndef LOADGEN_LATENCYHISTOGRAM_HPP
+#define LOADGEN_LATENCYHISTOGRAM_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace loadgen
+{
+
+/* Log-linear histogram of latencies in nanoseconds
+   Values below 2^SubBucketBits are exact. Above that each power of two range is split into 2^(SubBucketBits - 1)
+   linear buckets, so any value is reported within about 3% of its true value, in a few thousand counters. */
+class LatencyHistogram
+{
+public:
+    static constexpr int SubBucketBits = 6;
+
+    LatencyHistogram();
+
+    void record(std::uint64_t nanoseconds);
+    void reset();
+
+    std::uint64_t count() const { return m_count; }
+    std::uint64_t max() const { return m_max; }
+
+    // Smallest recorded value that at least the given fraction (0 to 1) of values are at or below
+    std::uint64_t percentile(double fraction) const;
+
+private:
+    static std::size_t bucketIndex(std::uint64_t value);
+    static std::uint64_t bucketUpperBound(std::size_t index);
+
+    std::vector<std::uint64_t> m_counts;
+    std::uint64_t m_count;
+    std::uint64_t m_max;
+};
+
+/* Record one event due at due, sent at sent and done at done
+   corrected is charged from when the event was due, so time spent behind schedule counts against every event it
+   delayed rather than being hidden by the sender waiting (coordinated omission). uncorrected is charged from when it
+   was sent, the service time alone. */
+void recordDispatch(LatencyHistogram & corrected, LatencyHistogram & uncorrected, std::chrono::steady_clock::time_point due,
+                    std::chrono::steady_clock::time_point sent, std::chrono::steady_clock::time_point done);
+
+} // end namespace loadgen
+
+#endif // LOADGEN_LATENCYHISTOGRAM_HPP
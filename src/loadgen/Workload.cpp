@@ -0,0 +1,94 @@
+#include "Workload.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+
+namespace loadgen
+{
+
+Workload::Workload(const WorkloadOptions & options)
+    : m_options(options)
+    , m_random(options.seed_)
+    , m_sessionsOpened(0)
+{
+    m_options.users_ = std::max<std::size_t>(m_options.users_, 1);
+    m_options.concurrentSessions_ = std::max<std::size_t>(m_options.concurrentSessions_, 1);
+    m_options.processes_ = std::clamp<std::size_t>(m_options.processes_, 1, 30000);
+
+    m_userIds.reserve(m_options.users_);
+    for(std::size_t i = 0; i < m_options.users_; ++i)
+    {
+        m_userIds.push_back("user" + std::to_string(i));
+    }
+    m_sessions.reserve(m_options.concurrentSessions_);
+}
+
+std::size_t Workload::pickUser()
+{
+    // A log-uniform pick is a cheap stand-in for Zipf: a few users are very active, most are rarely seen
+    std::uniform_real_distribution<double> exponent(0.0, std::log(static_cast<double>(m_options.users_)));
+    return std::min(static_cast<std::size_t>(std::exp(exponent(m_random))) - 1, m_options.users_ - 1);
+}
+
+EventSpec Workload::makeSpec(EventKind kind, const Session & session, int someSpecificData) const
+{
+    EventSpec spec{ kind, session.pid_, someSpecificData, 0, {} };
+    if(kind == EventKind::AUTH_LOGIN || kind == EventKind::AUTH_LOGOUT)
+    {
+        const std::string & userId = m_userIds[session.user_];
+        spec.idLength_ = static_cast<std::uint8_t>(std::min(userId.size(), MaxIdLength));
+        std::copy_n(userId.data(), spec.idLength_, spec.id_.data());
+    }
+    else
+    {
+        char sessionId[MaxIdLength + 1];
+        int length = std::snprintf(sessionId, sizeof(sessionId), "%016llx", static_cast<unsigned long long>(session.sessionId_));
+        spec.idLength_ = static_cast<std::uint8_t>(length);
+        std::copy_n(sessionId, spec.idLength_, spec.id_.data());
+    }
+    return spec;
+}
+
+EventSpec Workload::openSession()
+{
+    ++m_sessionsOpened;
+
+    std::uniform_int_distribution<std::size_t> process(0, m_options.processes_ - 1);
+    m_sessions.push_back(Session{ pickUser(), m_random(), static_cast<short>(1000 + process(m_random)), Stage::LOGGED_IN });
+
+    return makeSpec(EventKind::AUTH_LOGIN, m_sessions.back(), static_cast<int>(m_sessionsOpened));
+}
+
+EventSpec Workload::next()
+{
+    if(m_sessions.size() < m_options.concurrentSessions_)
+    {
+        return openSession();
+    }
+
+    std::uniform_int_distribution<std::size_t> pick(0, m_sessions.size() - 1);
+    std::size_t index = pick(m_random);
+    Session & session = m_sessions[index];
+
+    switch(session.stage_)
+    {
+        case Stage::LOGGED_IN:
+            session.stage_ = Stage::STARTED;
+            return makeSpec(EventKind::SESSION_START, session, static_cast<int>(index));
+        case Stage::STARTED:
+            session.stage_ = Stage::ENDED;
+            return makeSpec(EventKind::SESSION_END, session, static_cast<int>(index));
+        case Stage::ENDED:
+        default:
+        {
+            EventSpec logout = makeSpec(EventKind::AUTH_LOGOUT, session, static_cast<int>(index));
+            std::swap(session, m_sessions.back());
+            m_sessions.pop_back();
+            return logout;
+        }
+    }
+}
+
+} // end namespace loadgen
@@ -0,0 +1,81 @@
+#ifndef LOADGEN_WORKLOAD_HPP
+#define LOADGEN_WORKLOAD_HPP
+
+#include "commonlib/EventKind.hpp"
+
+#include <array>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace loadgen
+{
+
+using commonlib::EventKind;
+
+// Longest session or user id the workload produces
+constexpr std::size_t MaxIdLength = 23;
+
+// One event to produce, independent of the library that will represent it. Self contained, so it can be generated ahead
+struct EventSpec
+{
+    EventKind kind_;
+    short pid_;
+    int someSpecificData_;
+    std::uint8_t idLength_;
+    std::array<char, MaxIdLength> id_;      // Session or user id
+
+    std::string_view id() const { return std::string_view(id_.data(), idLength_); }
+};
+
+struct WorkloadOptions
+{
+    std::size_t users_ = 100000;            // Distinct user ids, picked with a Zipf-like skew
+    std::size_t concurrentSessions_ = 10000;// Sessions open at once in steady state
+    std::size_t processes_ = 64;            // Distinct reporting pids
+    std::uint64_t seed_ = 42;
+};
+
+/* Synthetic stream of auth and session events following each session's lifecycle
+   A session is AUTH_LOGIN, SESSION_START, SESSION_END then AUTH_LOGOUT for one user on one process. New sessions are
+   opened until the target concurrency is reached, after which each event advances a randomly chosen open session,
+   so session lengths are geometrically distributed around the concurrency. */
+class Workload
+{
+public:
+    explicit Workload(const WorkloadOptions & options);
+
+    EventSpec next();
+
+private:
+    enum class Stage
+    {
+        LOGGED_IN,
+        STARTED,
+        ENDED
+    };
+
+    struct Session
+    {
+        std::size_t user_;                  // Index into m_userIds
+        std::uint64_t sessionId_;           // Written as hex
+        short pid_;
+        Stage stage_;
+    };
+
+    std::size_t pickUser();
+    EventSpec openSession();
+    EventSpec makeSpec(EventKind kind, const Session & session, int someSpecificData) const;
+
+    WorkloadOptions m_options;
+    std::mt19937_64 m_random;
+    std::vector<std::string> m_userIds;
+    std::vector<Session> m_sessions;
+    std::uint64_t m_sessionsOpened;
+};
+
+} // end namespace loadgen
+
+#endif // LOADGEN_WORKLOAD_HPP
@@ -0,0 +1,304 @@
+#include "LatencyHistogram.hpp"
+#include "Workload.hpp"
+
+#include "classiclib/Events.hpp"
+#include "commonlib/AsyncFileWriter.hpp"
+#include "commonlib/Clock.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+
+using SteadyClock = std::chrono::steady_clock;
+
+struct Options
+{
+    std::string library_ = "classic";
+    std::vector<double> rates_ = { 10000, 50000, 100000, 200000, 500000, 1000000 };
+    double duration_ = 2.0;                 // Seconds per rate
+    std::string output_ = "temp.txt";       // "null" to format into a counting sink and write nothing
+    std::string clock_ = "system";          // What events are stamped from: system, tsc or coarse
+    loadgen::WorkloadOptions workload_;
+};
+
+struct StepResult
+{
+    double targetRate_;
+    double achievedRate_;
+    bool saturated_;                        // Fell so far behind that the step was cut short
+    loadgen::LatencyHistogram corrected_;   // From when each event was due
+    loadgen::LatencyHistogram uncorrected_; // From when each event was actually dispatched
+};
+
+// A step is abandoned once an event is this late, since past that point latency only measures the backlog
+constexpr auto s_maxLag = std::chrono::seconds(5);
+
+void printUsage()
+{
+    std::cerr << "Usage: loadgen [--lib=classic|purecomp|templatecast] [--rates=r1,r2,...] [--duration=seconds]\n"
+                 "               [--users=n] [--sessions=n] [--processes=n] [--output=path|null] [--clock=system|tsc|coarse]\n"
+                 "Drives the chosen library open loop at each target rate (events per second) and prints a CSV of\n"
+                 "achieved rate against latency percentiles in microseconds, measured from when each event was due.\n";
+}
+
+bool parseOptions(int argc, char ** argv, Options & options)
+{
+    for(int i = 1; i < argc; ++i)
+    {
+        std::string argument = argv[i];
+        auto value = [&argument](const char * name) -> const char *
+        {
+            std::size_t length = std::strlen(name);
+            return argument.compare(0, length, name) == 0 ? argument.c_str() + length : nullptr;
+        };
+
+        if(auto text = value("--lib="))
+        {
+            options.library_ = text;
+        }
+        else if(auto text = value("--rates="))
+        {
+            options.rates_.clear();
+            std::istringstream list(text);
+            for(std::string rate; std::getline(list, rate, ',');)
+            {
+                options.rates_.push_back(std::strtod(rate.c_str(), nullptr));
+            }
+        }
+        else if(auto text = value("--duration="))
+        {
+            options.duration_ = std::strtod(text, nullptr);
+        }
+        else if(auto text = value("--users="))
+        {
+            options.workload_.users_ = std::strtoull(text, nullptr, 10);
+        }
+        else if(auto text = value("--sessions="))
+        {
+            options.workload_.concurrentSessions_ = std::strtoull(text, nullptr, 10);
+        }
+        else if(auto text = value("--processes="))
+        {
+            options.workload_.processes_ = std::strtoull(text, nullptr, 10);
+        }
+        else if(auto text = value("--output="))
+        {
+            options.output_ = text;
+        }
+        else if(auto text = value("--clock="))
+        {
+            options.clock_ = text;
+        }
+        else
+        {
+            return false;
+        }
+    }
+
+    if(options.clock_ == "tsc" && !commonlib::TscClock::supported())
+    {
+        std::cerr << "--clock=tsc needs an invariant TSC, which this CPU does not have\n";
+        return false;
+    }
+    for(double rate : options.rates_)
+    {
+        if(rate <= 0.0)
+        {
+            return false;
+        }
+    }
+    return options.duration_ > 0.0
+        && (options.clock_ == "system" || options.clock_ == "tsc" || options.clock_ == "coarse")
+        && (options.library_ == "classic" || options.library_ == "purecomp" || options.library_ == "templatecast");
+}
+
+// Build the event the way a producer would, heap allocated and stamped from the clock, then hand it to the library
+template <class Sink, commonlib::TimestampClock Clock>
+void dispatchClassic(const loadgen::EventSpec & spec, Sink & sink, Clock & clock)
+{
+    std::unique_ptr<classiclib::EventBase> event;
+    const std::string id(spec.id());
+    switch(spec.kind_)
+    {
+        case commonlib::EventKind::SESSION_START: event.reset(new classiclib::SessionStartEvent{ spec.pid_, clock.now(), id, spec.someSpecificData_ }); break;
+        case commonlib::EventKind::SESSION_END:   event.reset(new classiclib::SessionEndEvent{ spec.pid_, clock.now(), id, spec.someSpecificData_ }); break;
+        case commonlib::EventKind::AUTH_LOGIN:    event.reset(new classiclib::AuthLoginEvent{ spec.pid_, clock.now(), id, spec.someSpecificData_ }); break;
+        case commonlib::EventKind::AUTH_LOGOUT:   event.reset(new classiclib::AuthLogoutEvent{ spec.pid_, clock.now(), id, spec.someSpecificData_ }); break;
+    }
+    classiclib::handleEvent(event.get(), sink);
+}
+
+template <class Sink, commonlib::TimestampClock Clock>
+void dispatchPureComp(const loadgen::EventSpec & spec, Sink & sink, Clock & clock)
+{
+    std::unique_ptr<purecomplib::Event> event;
+    const std::string id(spec.id());
+    switch(spec.kind_)
+    {
+        case commonlib::EventKind::SESSION_START: event = std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionStartEvent{spec.pid_, clock.now(), id, spec.someSpecificData_}}); break;
+        case commonlib::EventKind::SESSION_END:   event = std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{purecomplib::SessionEndEvent{spec.pid_, clock.now(), id, spec.someSpecificData_}}); break;
+        case commonlib::EventKind::AUTH_LOGIN:    event = std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLoginEvent{spec.pid_, clock.now(), id, spec.someSpecificData_}}); break;
+        case commonlib::EventKind::AUTH_LOGOUT:   event = std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{purecomplib::AuthLogoutEvent{spec.pid_, clock.now(), id, spec.someSpecificData_}}); break;
+    }
+    purecomplib::handleEvent(event.get(), sink);
+}
+
+template <class Sink, commonlib::TimestampClock Clock>
+void dispatchTemplateCast(const loadgen::EventSpec & spec, Sink & sink, Clock & clock)
+{
+    std::unique_ptr<templatecastlib::Event> event;
+    const std::string id(spec.id());
+    switch(spec.kind_)
+    {
+        case commonlib::EventKind::SESSION_START: event.reset(new templatecastlib::SessionStartEvent{ spec.pid_, clock.now(), id, spec.someSpecificData_ }); break;
+        case commonlib::EventKind::SESSION_END:   event.reset(new templatecastlib::SessionEndEvent{ spec.pid_, clock.now(), id, spec.someSpecificData_ }); break;
+        case commonlib::EventKind::AUTH_LOGIN:    event.reset(new templatecastlib::AuthLoginEvent{ spec.pid_, clock.now(), id, spec.someSpecificData_ }); break;
+        case commonlib::EventKind::AUTH_LOGOUT:   event.reset(new templatecastlib::AuthLogoutEvent{ spec.pid_, clock.now(), id, spec.someSpecificData_ }); break;
+    }
+    templatecastlib::handleEvent(event.get(), sink);
+}
+
+/* Run one rate open loop: event i is due at start + i / rate whether or not earlier events have finished
+   Latency is taken from the due time, so time spent queued behind a slow event counts against every event that
+   should have gone out meanwhile. Measuring from the actual dispatch instead hides that (coordinated omission), and
+   is reported alongside for comparison. */
+template <class Sink, class Dispatch>
+void runStep(const std::vector<loadgen::EventSpec> & specs, double rate, Sink & sink, Dispatch dispatch, StepResult & result)
+{
+    result.targetRate_ = rate;
+    result.saturated_ = false;
+    result.corrected_.reset();
+    result.uncorrected_.reset();
+
+    const double interval = 1e9 / rate;
+    const auto start = SteadyClock::now() + std::chrono::milliseconds(1);
+    auto done = start;
+
+    std::size_t dispatched = 0;
+    for(const auto & spec : specs)
+    {
+        const auto due = start + std::chrono::nanoseconds(static_cast<long long>(interval * static_cast<double>(dispatched)));
+
+        auto now = SteadyClock::now();
+        if(due - now > std::chrono::microseconds(200))
+        {
+            std::this_thread::sleep_until(due - std::chrono::microseconds(100));
+        }
+        while(now < due)
+        {
+            now = SteadyClock::now();
+        }
+
+        dispatch(spec, sink);
+        done = SteadyClock::now();
+        ++dispatched;
+
+        loadgen::recordDispatch(result.corrected_, result.uncorrected_, due, now, done);
+
+        if(done - due > s_maxLag)
+        {
+            result.saturated_ = true;
+            break;
+        }
+    }
+
+    result.achievedRate_ = static_cast<double>(dispatched) / std::chrono::duration<double>(done - start).count();
+}
+
+template <class Sink, commonlib::TimestampClock Clock>
+void runAll(const Options & options, Sink & sink, Clock & clock)
+{
+    loadgen::Workload workload(options.workload_);
+    StepResult result;
+
+    std::cout << "target_rate,achieved_rate,p50_us,p90_us,p99_us,p999_us,max_us,uncorrected_p99_us,saturated" << std::endl;
+    for(double rate : options.rates_)
+    {
+        // Generate the whole step up front so producing the stream is not part of the measurement
+        std::vector<loadgen::EventSpec> specs(static_cast<std::size_t>(rate * options.duration_));
+        for(auto & spec : specs)
+        {
+            spec = workload.next();
+        }
+
+        if(options.library_ == "classic")
+        {
+            runStep(specs, rate, sink, [&clock](const loadgen::EventSpec & spec, Sink & out) { dispatchClassic(spec, out, clock); }, result);
+        }
+        else if(options.library_ == "purecomp")
+        {
+            runStep(specs, rate, sink, [&clock](const loadgen::EventSpec & spec, Sink & out) { dispatchPureComp(spec, out, clock); }, result);
+        }
+        else
+        {
+            runStep(specs, rate, sink, [&clock](const loadgen::EventSpec & spec, Sink & out) { dispatchTemplateCast(spec, out, clock); }, result);
+        }
+
+        auto micros = [](std::uint64_t nanoseconds) { return static_cast<double>(nanoseconds) / 1000.0; };
+        std::cout << result.targetRate_ << ',' << result.achievedRate_ << ','
+                  << micros(result.corrected_.percentile(0.5)) << ','
+                  << micros(result.corrected_.percentile(0.9)) << ','
+                  << micros(result.corrected_.percentile(0.99)) << ','
+                  << micros(result.corrected_.percentile(0.999)) << ','
+                  << micros(result.corrected_.max()) << ','
+                  << micros(result.uncorrected_.percentile(0.99)) << ','
+                  << (result.saturated_ ? "yes" : "no") << std::endl;
+    }
+}
+
+template <class Sink>
+void runWithClock(const Options & options, Sink & sink)
+{
+    if(options.clock_ == "tsc")
+    {
+        commonlib::TscClock clock;
+        runAll(options, sink, clock);
+    }
+    else if(options.clock_ == "coarse")
+    {
+        commonlib::CoarseClock clock;
+        runAll(options, sink, clock);
+    }
+    else
+    {
+        commonlib::SystemClock clock;
+        runAll(options, sink, clock);
+    }
+}
+
+} // end anonymous namespace
+
+int main(int argc, char ** argv)
+{
+    Options options;
+    if(!parseOptions(argc, argv, options))
+    {
+        printUsage();
+        return 1;
+    }
+
+    if(options.output_ == "null")
+    {
+        commonlib::CountingSink sink;
+        runWithClock(options, sink);
+        return 0;
+    }
+
+    auto writer = commonlib::openAsyncFileWriter(options.output_);
+    commonlib::AsyncFileSink sink(*writer);
+    runWithClock(options, sink);
+    sink.close();
+    return 0;
+}
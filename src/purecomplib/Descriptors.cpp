@@ -0,0 +1,69 @@
+#include "purecomplib/Events.hpp"
+
+#include "commonlib/FieldDescriptor.hpp"
+
+#include <stdexcept>
+
+
+namespace purecomplib
+{
+
+namespace
+{
+
+using commonlib::describeField;
+
+// Fields reached through the nested base data structs, in the order the handlers write them
+template <class T>
+constexpr commonlib::FieldDescriptor s_sessionFields[] =
+{
+    describeField<T, &T::sessionBaseData_, &SessionEventBaseData::eventBaseData_, &EventBaseData::pid_>("pid", "PID is "),
+    describeField<T, &T::sessionBaseData_, &SessionEventBaseData::eventBaseData_, &EventBaseData::timestamp_>("timestamp", "Timestamp is "),
+    describeField<T, &T::sessionBaseData_, &SessionEventBaseData::sessionId_>("sessionId", "Session id is "),
+    describeField<T, &T::someSpecificData_>("someSpecificData",
+        std::is_same_v<T, SessionStartEvent> ? "Some specific data for SessionStartEvent: " : "Some specific data for SessionEndEvent: "),
+};
+
+template <class T>
+constexpr commonlib::FieldDescriptor s_authFields[] =
+{
+    describeField<T, &T::authBaseData_, &AuthEventBaseData::eventBaseData_, &EventBaseData::pid_>("pid", "PID is "),
+    describeField<T, &T::authBaseData_, &AuthEventBaseData::eventBaseData_, &EventBaseData::timestamp_>("timestamp", "Timestamp is "),
+    describeField<T, &T::authBaseData_, &AuthEventBaseData::userId_>("userId", "User is "),
+    describeField<T, &T::someSpecificData_>("someSpecificData",
+        std::is_same_v<T, AuthLoginEvent> ? "Some specific data for AuthLoginEvent: " : "Some specific data for AuthLogoutEvent: "),
+};
+
+// Must be updated when creating a new event type
+template <class T>
+constexpr commonlib::TypeDescriptor s_type{};
+
+template <>
+constexpr commonlib::TypeDescriptor s_type<SessionStartEvent>{ "SessionStartEvent", commonlib::EventKind::SESSION_START, s_sessionFields<SessionStartEvent> };
+template <>
+constexpr commonlib::TypeDescriptor s_type<SessionEndEvent>{ "SessionEndEvent", commonlib::EventKind::SESSION_END, s_sessionFields<SessionEndEvent> };
+template <>
+constexpr commonlib::TypeDescriptor s_type<AuthLoginEvent>{ "AuthLoginEvent", commonlib::EventKind::AUTH_LOGIN, s_authFields<AuthLoginEvent> };
+template <>
+constexpr commonlib::TypeDescriptor s_type<AuthLogoutEvent>{ "AuthLogoutEvent", commonlib::EventKind::AUTH_LOGOUT, s_authFields<AuthLogoutEvent> };
+
+} // end anonymous namespace
+
+commonlib::DescribedEvent describe(const Event * event)
+{
+    if(!event)
+    {
+        throw std::invalid_argument("event pointer is null");
+    }
+
+    return std::visit([](auto && subtype)
+    {
+        return std::visit([](auto && concreteEvent)
+        {
+            using T = std::decay_t<decltype(concreteEvent)>;
+            return commonlib::DescribedEvent{ &s_type<T>, &concreteEvent };
+        }, subtype);
+    }, *event);
+}
+
+} // end namespace purecomplib
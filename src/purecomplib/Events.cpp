@@ -1,5 +1,7 @@
 #include "purecomplib/Events.hpp"
-#include <iomanip>
+
+#include "commonlib/Hash.hpp"
+
 #include <stdexcept>
 
 
@@ -26,112 +28,111 @@ AuthLogoutEvent::AuthLogoutEvent(short pid, std::chrono::system_clock::time_poin
     , someSpecificData_(specificData)
 {}
 
-void handleAuthEvent(const AuthEvent * authEvent, std::ostream & out)
+std::unique_ptr<Event> makeEvent(const commonlib::ParsedEvent & parsed)
 {
-    if (!authEvent)
+    const std::string id(parsed.id_);
+    switch(parsed.kind_)
     {
-        throw std::invalid_argument("authEvent pointer is null");
+        case commonlib::EventKind::SESSION_START: return std::make_unique<Event>(SessionEvent{SessionStartEvent{parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_}});
+        case commonlib::EventKind::SESSION_END:   return std::make_unique<Event>(SessionEvent{SessionEndEvent{parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_}});
+        case commonlib::EventKind::AUTH_LOGIN:    return std::make_unique<Event>(AuthEvent{AuthLoginEvent{parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_}});
+        case commonlib::EventKind::AUTH_LOGOUT:   return std::make_unique<Event>(AuthEvent{AuthLogoutEvent{parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_}});
     }
+    throw std::invalid_argument("Unknown event type encountered");
+}
 
-    if(!out)
+commonlib::EventKind eventKind(const Event * event)
+{
+    if(!event)
     {
-        throw std::invalid_argument("Output stream is not valid");
+        throw std::invalid_argument("event pointer is null");
     }
 
-    std::visit([&out](auto && concreteEvent) 
+    // Must be updated when creating a new event type
+    return std::visit([](auto && subtype)
     {
-        using T = std::decay_t<decltype(concreteEvent)>;
-
-        // Handle event base data
-        out << "PID is " << concreteEvent.authBaseData_.eventBaseData_.pid_ << "\n";
-
-        std::time_t time = std::chrono::system_clock::to_time_t(concreteEvent.authBaseData_.eventBaseData_.timestamp_);
-        std::tm tm = *std::localtime(&time); // Convert to local time
-        out << "Timestamp is " << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << std::endl;
-
-        // Handle auth event base data
-        out << "User is " << concreteEvent.authBaseData_.userId_ << "\n";
-
-        if constexpr (std::is_same_v<T, AuthLoginEvent>)
-        {
-            out << "Some specific data for AuthLoginEvent: " << concreteEvent.someSpecificData_ << "\n";
-        }
-        else if constexpr (std::is_same_v<T, AuthLogoutEvent>)
+        using T = std::decay_t<decltype(subtype)>;
+        if constexpr (std::is_same_v<T, SessionEvent>)
         {
-            out << "Some specific data for AuthLogoutEvent: " << concreteEvent.someSpecificData_ << "\n";
+            return std::holds_alternative<SessionStartEvent>(subtype) ? commonlib::EventKind::SESSION_START : commonlib::EventKind::SESSION_END;
         }
         else
         {
-            throw std::runtime_error("Unknown AuthEvent type");
+            return std::holds_alternative<AuthLoginEvent>(subtype) ? commonlib::EventKind::AUTH_LOGIN : commonlib::EventKind::AUTH_LOGOUT;
         }
-    }, *authEvent);
+    }, *event);
 }
 
-void handleSessionEvent(const SessionEvent * sessionEvent, std::ostream & out)
+std::uint64_t samplingKey(const Event * event)
 {
-    if (!sessionEvent)
+    if(!event)
     {
-        throw std::invalid_argument("sessionEvent pointer is null");
+        throw std::invalid_argument("event pointer is null");
     }
 
-    if(!out)
-    {
-        throw std::invalid_argument("Output stream is not valid");
-    }
-    
-    std::visit([&out](auto&& concreteEvent)
+    return std::visit([](auto && subtype)
     {
-        using T = std::decay_t<decltype(concreteEvent)>;
-
-        // Handle event base data
-        // concreteEvent.sessionBaseData_.eventBaseData_.pid_  is really inconvenient
-        out << "PID is " << concreteEvent.sessionBaseData_.eventBaseData_.pid_ << "\n";
-
-        std::time_t time = std::chrono::system_clock::to_time_t(concreteEvent.sessionBaseData_.eventBaseData_.timestamp_);
-        std::tm tm = *std::localtime(&time); // Convert to local time
-        out << "Timestamp is " << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << std::endl;
-
-        // Handle session event base data
-        out << "Session id is " << concreteEvent.sessionBaseData_.sessionId_ << "\n";
-
-        if constexpr (std::is_same_v<T, SessionStartEvent>)
-        {
-            out << "Some specific data for SessionStartEvent: " << concreteEvent.someSpecificData_ << "\n";
-        }
-        else if constexpr (std::is_same_v<T, SessionEndEvent>)
-        {
-            out << "Some specific data for SessionEndEvent: " << concreteEvent.someSpecificData_ << "\n";
-        }
-        else
+        using Family = std::decay_t<decltype(subtype)>;
+        return std::visit([](auto && concreteEvent)
         {
-            throw std::runtime_error("Unknown SessionEvent type");
-        }
-    }, *sessionEvent);
+            if constexpr (std::is_same_v<Family, SessionEvent>)
+            {
+                return commonlib::hashBytes(concreteEvent.sessionBaseData_.sessionId_);
+            }
+            else
+            {
+                return commonlib::hashBytes(concreteEvent.authBaseData_.userId_);
+            }
+        }, subtype);
+    }, *event);
 }
 
-void handleEvent(const Event * event, std::ostream & out)
+std::uint64_t fingerprint(const Event * event)
 {
     if(!event)
     {
         throw std::invalid_argument("event pointer is null");
     }
 
+    return std::visit([](auto && subtype)
+    {
+        using Family = std::decay_t<decltype(subtype)>;
+
+        // The position in both variant levels identifies the type
+        const std::uint64_t type = (std::is_same_v<Family, AuthEvent> ? 2 : 0) + subtype.index();
+
+        return std::visit([type](auto && concreteEvent)
+        {
+            std::uint64_t hash = 0;
+            if constexpr (std::is_same_v<Family, SessionEvent>)
+            {
+                const auto & baseData = concreteEvent.sessionBaseData_;
+                hash = commonlib::combineHash(type, static_cast<std::uint64_t>(baseData.eventBaseData_.pid_));
+                hash = commonlib::combineHash(hash, static_cast<std::uint64_t>(baseData.eventBaseData_.timestamp_.time_since_epoch().count()));
+                hash = commonlib::hashBytes(baseData.sessionId_, hash);
+            }
+            else
+            {
+                const auto & baseData = concreteEvent.authBaseData_;
+                hash = commonlib::combineHash(type, static_cast<std::uint64_t>(baseData.eventBaseData_.pid_));
+                hash = commonlib::combineHash(hash, static_cast<std::uint64_t>(baseData.eventBaseData_.timestamp_.time_since_epoch().count()));
+                hash = commonlib::hashBytes(baseData.userId_, hash);
+            }
+            return commonlib::combineHash(hash, static_cast<std::uint32_t>(concreteEvent.someSpecificData_));
+        }, subtype);
+    }, *event);
+}
+
+void handleEvent(const Event * event, std::ostream & out)
+{
     if(!out)
     {
         throw std::invalid_argument("Output stream is not valid");
     }
 
-    std::visit([&](auto&& subtype) {
-        using T = std::decay_t<decltype(subtype)>;
-        if constexpr (std::is_same_v<T, AuthEvent>)
-        {
-            handleAuthEvent(&subtype, out);
-        } 
-        else if constexpr (std::is_same_v<T, SessionEvent>)
-        {
-            handleSessionEvent(&subtype, out);
-        }
-    }, *event);
+    commonlib::OstreamSink sink(out);
+    handleEvent(event, sink);
+    out.flush();
 }
 
-} // namespace purecomplib
\ No newline at end of file
+} // namespace purecomplib
@@ -0,0 +1,83 @@
+#include "templatecastlib/Events.hpp"
+
+#include "commonlib/FieldDescriptor.hpp"
+
+#include <stdexcept>
+
+
+namespace templatecastlib
+{
+
+namespace
+{
+
+using commonlib::describeField;
+
+// Base members first, in the order handleEvent writes them. Labels are the handler's own text, names the same as the
+// other libraries', so specificData_ is described as someSpecificData
+constexpr commonlib::FieldDescriptor s_sessionStartFields[] =
+{
+    describeField<SessionStartEvent, &SessionStartEvent::pid_>("pid", "PID is "),
+    describeField<SessionStartEvent, &SessionStartEvent::timestamp_>("timestamp", "Timestamp is "),
+    describeField<SessionStartEvent, &SessionStartEvent::sessionId_>("sessionId", "Session id is "),
+    describeField<SessionStartEvent, &SessionStartEvent::specificData_>("someSpecificData", "Specific data for session start event: "),
+};
+
+constexpr commonlib::FieldDescriptor s_sessionEndFields[] =
+{
+    describeField<SessionEndEvent, &SessionEndEvent::pid_>("pid", "PID is "),
+    describeField<SessionEndEvent, &SessionEndEvent::timestamp_>("timestamp", "Timestamp is "),
+    describeField<SessionEndEvent, &SessionEndEvent::sessionId_>("sessionId", "Session id is "),
+    describeField<SessionEndEvent, &SessionEndEvent::specificData_>("someSpecificData", "Specific data for session end event: "),
+};
+
+constexpr commonlib::FieldDescriptor s_authLoginFields[] =
+{
+    describeField<AuthLoginEvent, &AuthLoginEvent::pid_>("pid", "PID is "),
+    describeField<AuthLoginEvent, &AuthLoginEvent::timestamp_>("timestamp", "Timestamp is "),
+    describeField<AuthLoginEvent, &AuthLoginEvent::userId_>("userId", "User is "),
+    describeField<AuthLoginEvent, &AuthLoginEvent::specificData_>("someSpecificData", "Specific data for auth login event: "),
+};
+
+constexpr commonlib::FieldDescriptor s_authLogoutFields[] =
+{
+    describeField<AuthLogoutEvent, &AuthLogoutEvent::pid_>("pid", "PID is "),
+    describeField<AuthLogoutEvent, &AuthLogoutEvent::timestamp_>("timestamp", "Timestamp is "),
+    describeField<AuthLogoutEvent, &AuthLogoutEvent::userId_>("userId", "User is "),
+    describeField<AuthLogoutEvent, &AuthLogoutEvent::specificData_>("someSpecificData", "Specific data for auth logout event: "),
+};
+
+constexpr commonlib::TypeDescriptor s_sessionStart{ "SessionStartEvent", commonlib::EventKind::SESSION_START, s_sessionStartFields };
+constexpr commonlib::TypeDescriptor s_sessionEnd{ "SessionEndEvent", commonlib::EventKind::SESSION_END, s_sessionEndFields };
+constexpr commonlib::TypeDescriptor s_authLogin{ "AuthLoginEvent", commonlib::EventKind::AUTH_LOGIN, s_authLoginFields };
+constexpr commonlib::TypeDescriptor s_authLogout{ "AuthLogoutEvent", commonlib::EventKind::AUTH_LOGOUT, s_authLogoutFields };
+
+} // end anonymous namespace
+
+commonlib::DescribedEvent describe(const Event * event)
+{
+    if(!event)
+    {
+        throw std::invalid_argument("Event pointer is null");
+    }
+
+    if(auto sessionStartEvent = event->cast<SessionStartEvent>())
+    {
+        return commonlib::DescribedEvent{ &s_sessionStart, sessionStartEvent };
+    }
+    if(auto sessionEndEvent = event->cast<SessionEndEvent>())
+    {
+        return commonlib::DescribedEvent{ &s_sessionEnd, sessionEndEvent };
+    }
+    if(auto loginEvent = event->cast<AuthLoginEvent>())
+    {
+        return commonlib::DescribedEvent{ &s_authLogin, loginEvent };
+    }
+    if(auto logoutEvent = event->cast<AuthLogoutEvent>())
+    {
+        return commonlib::DescribedEvent{ &s_authLogout, logoutEvent };
+    }
+    throw std::invalid_argument("Unknown event type encountered");
+}
+
+} // end namespace templatecastlib
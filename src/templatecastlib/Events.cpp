@@ -1,7 +1,8 @@
 
 #include "templatecastlib/Events.hpp"
 
-#include <iomanip>
+#include "commonlib/Hash.hpp"
+
 #include <stdexcept>
 
 
@@ -34,91 +35,108 @@ AuthLogoutEvent::AuthLogoutEvent(short pid, std::chrono::system_clock::time_poin
     , specificData_(specificData)
 {}
 
-void handleSessionEvent(const SessionEventBase * sessionEvent, std::ostream & out)
+std::unique_ptr<Event> makeEvent(const commonlib::ParsedEvent & parsed)
 {
-    if(!sessionEvent)
+    const std::string id(parsed.id_);
+    switch(parsed.kind_)
     {
-        throw std::invalid_argument("Session event pointer is null");
+        case commonlib::EventKind::SESSION_START: return std::make_unique<SessionStartEvent>(parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_);
+        case commonlib::EventKind::SESSION_END:   return std::make_unique<SessionEndEvent>(parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_);
+        case commonlib::EventKind::AUTH_LOGIN:    return std::make_unique<AuthLoginEvent>(parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_);
+        case commonlib::EventKind::AUTH_LOGOUT:   return std::make_unique<AuthLogoutEvent>(parsed.pid_, parsed.timestamp_, id, parsed.someSpecificData_);
     }
+    throw std::invalid_argument("Unknown event type encountered");
+}
 
-    if(!out)
+commonlib::EventKind eventKind(const Event * event)
+{
+    if(!event)
     {
-        throw std::invalid_argument("Output stream is not valid");
+        throw std::invalid_argument("Event pointer is null");
     }
 
-    out << "Session id is " << sessionEvent->sessionId_ << "\n";
-
-    if(auto sessionStartEvent = sessionEvent->cast<SessionStartEvent>())
+    switch(event->eventType())
     {
-        out << "Specific data for session start event: " << sessionStartEvent->specificData_ << "\n";
-    }
-    else if(auto sessionEndEvent = sessionEvent->cast<SessionEndEvent>())
-    {
-        out << "Specific data for session end event: " << sessionEndEvent->specificData_ << "\n";
-    }
-    else
-    {
-        throw std::invalid_argument("Unknown session event type encountered");
+        case SessionStartEvent::TypeId: return commonlib::EventKind::SESSION_START;
+        case SessionEndEvent::TypeId:   return commonlib::EventKind::SESSION_END;
+        case AuthLoginEvent::TypeId:    return commonlib::EventKind::AUTH_LOGIN;
+        case AuthLogoutEvent::TypeId:   return commonlib::EventKind::AUTH_LOGOUT;
+        default:
+            throw std::invalid_argument("Unknown event type encountered");
     }
 }
 
-void handleAuthEvent(const AuthEventBase * authEvent, std::ostream & out)
+std::uint64_t samplingKey(const Event * event)
 {
-    if(!authEvent)
-    {
-        throw std::invalid_argument("Auth event pointer is null");
-    }
-
-    if(!out)
+    if(!event)
     {
-        throw std::invalid_argument("Output stream is not valid");
+        throw std::invalid_argument("Event pointer is null");
     }
 
-    out << "User is " << authEvent->userId_ << "\n";
-
-    if(auto loginEvent = authEvent->cast<AuthLoginEvent>())
+    if(auto sessionEvent = event->cast<SessionEventBase>())
     {
-        out << "Specific data for auth login event: " << loginEvent->specificData_ << "\n";
+        return commonlib::hashBytes(sessionEvent->sessionId_);
     }
-    else if(auto logoutEvent = authEvent->cast<AuthLogoutEvent>())
+    if(auto authEvent = event->cast<AuthEventBase>())
     {
-        out << "Specific data for auth logout event: " << logoutEvent->specificData_ << "\n";
-    }
-    else
-    {
-        throw std::invalid_argument("Unknown auth event type encountered");
+        return commonlib::hashBytes(authEvent->userId_);
     }
+    throw std::invalid_argument("Unknown event type encountered");
 }
 
-void handleEvent(const Event * event, std::ostream & out)
+std::uint64_t fingerprint(const Event * event)
 {
     if(!event)
     {
         throw std::invalid_argument("Event pointer is null");
     }
-    if(!out)
-    {
-        throw std::invalid_argument("Output stream is not valid");
-    }
-
-    out << "PID is " << event->pid_ << std::endl;out << "PID is " << event->pid_ << std::endl;
 
-    std::time_t time = std::chrono::system_clock::to_time_t(event->timestamp_);
-    std::tm tm = *std::localtime(&time); // Convert to local time
-    out << "Timestamp is " << std::put_time(&tm, "%Y-%m-%d %H:%M:%S") << std::endl;
+    std::uint64_t hash = commonlib::combineHash(static_cast<std::uint64_t>(event->eventType()), static_cast<std::uint64_t>(event->pid_));
+    hash = commonlib::combineHash(hash, static_cast<std::uint64_t>(event->timestamp_.time_since_epoch().count()));
 
+    int specificData = 0;
     if(auto sessionEvent = event->cast<SessionEventBase>())
     {
-        handleSessionEvent(sessionEvent, out);
+        hash = commonlib::hashBytes(sessionEvent->sessionId_, hash);
+        if(auto sessionStartEvent = event->cast<SessionStartEvent>())
+        {
+            specificData = sessionStartEvent->specificData_;
+        }
+        else if(auto sessionEndEvent = event->cast<SessionEndEvent>())
+        {
+            specificData = sessionEndEvent->specificData_;
+        }
     }
     else if(auto authEvent = event->cast<AuthEventBase>())
     {
-        handleAuthEvent(authEvent, out);
+        hash = commonlib::hashBytes(authEvent->userId_, hash);
+        if(auto loginEvent = event->cast<AuthLoginEvent>())
+        {
+            specificData = loginEvent->specificData_;
+        }
+        else if(auto logoutEvent = event->cast<AuthLogoutEvent>())
+        {
+            specificData = logoutEvent->specificData_;
+        }
     }
     else
     {
         throw std::invalid_argument("Unknown event type encountered");
     }
+
+    return commonlib::combineHash(hash, static_cast<std::uint32_t>(specificData));
+}
+
+void handleEvent(const Event * event, std::ostream & out)
+{
+    if(!out)
+    {
+        throw std::invalid_argument("Output stream is not valid");
+    }
+
+    commonlib::OstreamSink sink(out);
+    handleEvent(event, sink);
+    out.flush();
 }
 
-} // end namespace templatecastlib
\ No newline at end of file
+} // end namespace templatecastlib
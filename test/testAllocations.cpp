@@ -0,0 +1,70 @@
+#include "alloctracklib/AllocTracker.hpp"
+#include "classiclib/Events.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+#include <gtest/gtest.h>
+
+#include <memory>
+
+
+/*
+* @ brief test that events with short ids never touch the heap
+* @ detail Procedure: Construct one event of each library on the stack with an id that fits the small string buffer
+*          Expected: No allocations are made
+*/
+TEST(TestAllocations, stackEventsWithShortIdsDoNotAllocate)
+{
+    const auto now = std::chrono::system_clock::now();
+
+    alloctracklib::AllocScope scope;
+    {
+        classiclib::SessionStartEvent classicEvent{ 9876, now, "session123", 42 };
+        purecomplib::Event pureCompEvent{ purecomplib::AuthEvent{ purecomplib::AuthLoginEvent{ 6789, now, "Fred", 42 } } };
+        templatecastlib::AuthLogoutEvent templateCastEvent{ 6789, now, "Fred", 42 };
+    }
+
+    EXPECT_EQ(0u, scope.stats().allocations_);
+}
+
+/*
+* @ brief test that the tracker counts heap events and their ids
+* @ detail Procedure: Create a heap event with a short id, then one with an id too long for the small string buffer
+*          Expected: One allocation for the first, two for the second, and nothing left live once both are destroyed
+*/
+TEST(TestAllocations, heapEventsAreCounted)
+{
+    const auto now = std::chrono::system_clock::now();
+    const std::string longSessionId = "a session id that does not fit in place";
+
+    alloctracklib::AllocScope scope;
+    {
+        auto shortId = std::make_unique<classiclib::SessionStartEvent>(9876, now, "session123", 42);
+        EXPECT_EQ(1u, scope.stats().allocations_);
+        EXPECT_GE(scope.stats().bytesAllocated_, sizeof(classiclib::SessionStartEvent));
+
+        auto longId = std::make_unique<classiclib::SessionStartEvent>(9876, now, longSessionId, 42);
+        EXPECT_EQ(3u, scope.stats().allocations_);
+    }
+
+    auto stats = scope.stats();
+    EXPECT_EQ(stats.allocations_, stats.deallocations_);
+    EXPECT_EQ(0, stats.liveBytes_);
+    EXPECT_GE(stats.peakLiveBytes_, static_cast<long long>(2 * sizeof(classiclib::SessionStartEvent)));
+}
+
+/*
+* @ brief test that peak live bytes are measured from the start of a nested scope
+* @ detail Procedure: Allocate a large block in an outer scope, then a small one in an inner scope
+*          Expected: The inner peak only covers the small block, the outer peak covers both
+*/
+TEST(TestAllocations, nestedScopePeaks)
+{
+    alloctracklib::AllocScope outer;
+    auto large = std::make_unique<char[]>(4096);
+    {
+        alloctracklib::AllocScope inner;
+        auto small = std::make_unique<char[]>(16);
+        EXPECT_LT(inner.stats().peakLiveBytes_, 4096);
+    }
+    EXPECT_GE(outer.stats().peakLiveBytes_, 4096 + 16);
+}
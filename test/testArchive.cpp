@@ -0,0 +1,328 @@
+#include "classiclib/Events.hpp"
+#include "commonlib/Archive.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+#include <gtest/gtest.h>
+
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+using namespace std::chrono;
+
+const auto s_now = system_clock::now();
+
+struct Expected
+{
+    commonlib::EventKind kind_;
+    short pid_;
+    system_clock::time_point timestamp_;
+    std::string id_;
+    int someSpecificData_;
+};
+
+// Every event in the archive, block after block
+std::vector<commonlib::ParsedEvent> readAll(std::string_view archive, commonlib::ArchiveReader::Unpack unpack)
+{
+    commonlib::ArchiveReader reader(archive, unpack);
+    std::vector<commonlib::ParsedEvent> all;
+    std::vector<commonlib::ParsedEvent> block;
+    while(reader.nextBlock(block))
+    {
+        all.insert(all.end(), block.begin(), block.end());
+    }
+    return all;
+}
+
+void expectEqual(const std::vector<commonlib::ParsedEvent> & decoded, const std::vector<Expected> & expected)
+{
+    ASSERT_EQ(decoded.size(), expected.size());
+    for(std::size_t i = 0; i < expected.size(); ++i)
+    {
+        EXPECT_EQ(decoded[i].kind_, expected[i].kind_) << "event " << i;
+        EXPECT_EQ(decoded[i].pid_, expected[i].pid_) << "event " << i;
+        EXPECT_EQ(decoded[i].timestamp_, expected[i].timestamp_) << "event " << i;
+        EXPECT_EQ(decoded[i].id_, expected[i].id_) << "event " << i;
+        EXPECT_EQ(decoded[i].someSpecificData_, expected[i].someSpecificData_) << "event " << i;
+        EXPECT_EQ(decoded[i].weight_, 1.0) << "event " << i;
+    }
+}
+
+std::vector<commonlib::ArchiveReader::Unpack> supportedUnpacks()
+{
+    std::vector<commonlib::ArchiveReader::Unpack> unpacks;
+    for(auto unpack : { commonlib::ArchiveReader::AUTO, commonlib::ArchiveReader::AVX2, commonlib::ArchiveReader::SCALAR })
+    {
+        if(commonlib::ArchiveReader::supported(unpack))
+        {
+            unpacks.push_back(unpack);
+        }
+    }
+    return unpacks;
+}
+
+} // end anonymous namespace
+
+/*
+* @ brief test archiving events from all three libraries and rebuilding them
+* @ detail Procedure: Append each library's four types through describe(), in blocks of 5, decode and rebuild with makeEvent()
+*          Expected: Three blocks, and every field of every event back as it went in
+*/
+TEST(TestArchive, roundTripAllLibraries)
+{
+    std::unique_ptr<classiclib::EventBase> classic[] =
+    {
+        std::make_unique<classiclib::SessionStartEvent>(9876, s_now, "session123", 1),
+        std::make_unique<classiclib::SessionEndEvent>(9876, s_now + milliseconds(5), "session123", -2),
+        std::make_unique<classiclib::AuthLoginEvent>(-6789, s_now + milliseconds(7), "Fred", 3),
+        std::make_unique<classiclib::AuthLogoutEvent>(6789, s_now + milliseconds(7), "Fred", 4),
+    };
+    purecomplib::Event purecomp[] =
+    {
+        purecomplib::SessionEvent{ purecomplib::SessionStartEvent{ 1, s_now - seconds(3), "s", 5 } },
+        purecomplib::SessionEvent{ purecomplib::SessionEndEvent{ 2, s_now, "s", 6 } },
+        purecomplib::AuthEvent{ purecomplib::AuthLoginEvent{ 3, s_now, "Barney", 7 } },
+        purecomplib::AuthEvent{ purecomplib::AuthLogoutEvent{ 4, s_now, "", 8 } },
+    };
+    std::unique_ptr<templatecastlib::Event> templatecast[] =
+    {
+        std::make_unique<templatecastlib::SessionStartEvent>(5, s_now, "t", 9),
+        std::make_unique<templatecastlib::SessionEndEvent>(6, s_now, "t", 10),
+        std::make_unique<templatecastlib::AuthLoginEvent>(7, s_now, "Wilma", 11),
+        std::make_unique<templatecastlib::AuthLogoutEvent>(8, s_now, "Wilma", 12),
+    };
+
+    commonlib::ArchiveWriter writer(5);
+    for(const auto & event : classic)
+    {
+        writer.append(classiclib::describe(event.get()));
+    }
+    for(const auto & event : purecomp)
+    {
+        writer.append(purecomplib::describe(&event));
+    }
+    for(const auto & event : templatecast)
+    {
+        writer.append(templatecastlib::describe(event.get()));
+    }
+    writer.finish();
+    EXPECT_EQ(writer.events(), 12u);
+
+    for(auto unpack : supportedUnpacks())
+    {
+        commonlib::ArchiveReader reader(writer.data(), unpack);
+        std::vector<commonlib::ParsedEvent> events;
+        std::size_t blocks = 0;
+        std::string rebuilt;
+        std::string original;
+        std::size_t next = 0;
+        while(reader.nextBlock(events))
+        {
+            ++blocks;
+            for(const auto & event : events)
+            {
+                // Rebuild with the library that wrote the event, and compare the handlers' output
+                if(next < 4)
+                {
+                    classiclib::handleEvent(classiclib::makeEvent(event).get(), rebuilt);
+                    classiclib::handleEvent(classic[next].get(), original);
+                }
+                else if(next < 8)
+                {
+                    purecomplib::handleEvent(purecomplib::makeEvent(event).get(), rebuilt);
+                    purecomplib::handleEvent(&purecomp[next - 4], original);
+                }
+                else
+                {
+                    templatecastlib::handleEvent(templatecastlib::makeEvent(event).get(), rebuilt);
+                    templatecastlib::handleEvent(templatecast[next - 8].get(), original);
+                }
+                ++next;
+            }
+        }
+        EXPECT_EQ(blocks, 3u);
+        EXPECT_EQ(next, 12u);
+        EXPECT_EQ(rebuilt, original);
+    }
+}
+
+/*
+* @ brief test that every value survives the encodings, however awkward
+* @ detail Procedure: Archive random events with out of order timestamps spanning centuries, extreme pids and data
+*          and many distinct ids, in blocks of several sizes, then decode with each unpack the CPU supports
+*          Expected: Every field back exactly
+*/
+TEST(TestArchive, extremeValues)
+{
+    std::mt19937_64 random(42);
+    std::vector<Expected> expected;
+    const auto span = duration_cast<system_clock::duration>(hours(24 * 365 * 200)).count();
+    for(int i = 0; i < 3000; ++i)
+    {
+        Expected event;
+        event.kind_ = static_cast<commonlib::EventKind>(random() % commonlib::EventKindCount);
+        event.pid_ = i % 100 == 0 ? SHRT_MIN : static_cast<short>(random());
+        event.timestamp_ = i % 3 == 0 ? s_now + system_clock::duration(static_cast<system_clock::rep>(random() % span) - span / 2)
+                                      : s_now + microseconds(i);
+        event.id_ = "user" + std::to_string(random() % 500);
+        event.someSpecificData_ = i % 7 == 0 ? INT_MIN : i % 11 == 0 ? INT_MAX : static_cast<int>(random());
+        expected.push_back(event);
+    }
+
+    for(std::size_t blockEvents : { 1, 2, 3, 1000, 4096 })
+    {
+        commonlib::ArchiveWriter writer(blockEvents);
+        for(const auto & event : expected)
+        {
+            writer.append(commonlib::ParsedEvent{ event.kind_, event.pid_, event.timestamp_, event.id_, event.someSpecificData_, 1.0 });
+        }
+        writer.finish();
+
+        for(auto unpack : supportedUnpacks())
+        {
+            SCOPED_TRACE(blockEvents);
+            expectEqual(readAll(writer.data(), unpack), expected);
+        }
+    }
+}
+
+/*
+* @ brief test the size of a typical archive
+* @ detail Procedure: Archive 100000 events a millisecond apart from 8 pids, 1000 users and small specific data
+*          Expected: Under 6 bytes an event, most of it the ids, against about 100 as text
+*/
+TEST(TestArchive, compression)
+{
+    std::mt19937 random(7);
+    commonlib::ArchiveWriter writer;
+    std::string text;
+    for(int i = 0; i < 100000; ++i)
+    {
+        const auto user = "user" + std::to_string(random() % 1000);
+        classiclib::AuthLoginEvent event(static_cast<short>(1000 + random() % 8), s_now + milliseconds(i), user, static_cast<int>(random() % 100));
+        writer.append(classiclib::describe(&event));
+        if(i < 100)
+        {
+            classiclib::handleEvent(&event, text);
+        }
+    }
+    writer.finish();
+
+    const double bytesPerEvent = static_cast<double>(writer.data().size()) / 100000;
+    EXPECT_LT(bytesPerEvent, 6.0);
+    EXPECT_GT(static_cast<double>(text.size()) / 100, 90.0);
+    EXPECT_EQ(readAll(writer.data(), commonlib::ArchiveReader::AUTO).size(), 100000u);
+}
+
+/*
+* @ brief test that long distinct ids end a block early
+* @ detail Procedure: Archive 100 events with ids of 10 bytes, each new id every other event, limiting a block's ids to
+*          64 bytes, then add an id longer than the limit
+*          Expected: Blocks of 12 events, 6 distinct ids each, and every event back as it went in; std::length_error
+*          for the long id, and std::invalid_argument for limits of 0 or over the maximum
+*/
+TEST(TestArchive, idBytesEndBlock)
+{
+    commonlib::ArchiveWriter writer(4096, 64);
+    std::vector<Expected> expected;
+    for(int i = 0; i < 100; ++i)
+    {
+        char id[16];
+        std::snprintf(id, sizeof(id), "user%06d", i / 2);
+        expected.push_back(Expected{ commonlib::EventKind::AUTH_LOGIN, 1, s_now + seconds(i), id, i });
+        writer.append(commonlib::ParsedEvent{ commonlib::EventKind::AUTH_LOGIN, 1, s_now + seconds(i), id, i, 1.0 });
+    }
+    writer.finish();
+
+    commonlib::ArchiveReader reader(writer.data());
+    std::vector<commonlib::ParsedEvent> block;
+    std::vector<std::size_t> sizes;
+    std::vector<commonlib::ParsedEvent> all;
+    while(reader.nextBlock(block))
+    {
+        sizes.push_back(block.size());
+        all.insert(all.end(), block.begin(), block.end());
+    }
+    EXPECT_EQ(sizes, (std::vector<std::size_t>{ 12, 12, 12, 12, 12, 12, 12, 12, 4 }));
+    expectEqual(all, expected);
+
+    EXPECT_THROW(writer.append(commonlib::ParsedEvent{ commonlib::EventKind::AUTH_LOGIN, 1, s_now, std::string(65, 'x'), 0, 1.0 }), std::length_error);
+    EXPECT_THROW(commonlib::ArchiveWriter(16, 0), std::invalid_argument);
+    EXPECT_THROW(commonlib::ArchiveWriter(16, commonlib::ArchiveWriter::MaxBlockIdBytes + 1), std::invalid_argument);
+}
+
+/*
+* @ brief test skipping blocks by time range
+* @ detail Procedure: Archive an hour of events a second apart in blocks of 600, then read back ten minutes from the middle
+*          Expected: Only the blocks overlapping the range are decoded, the rest counted as skipped
+*/
+TEST(TestArchive, timeRangeSkipsBlocks)
+{
+    const auto start = time_point_cast<seconds>(s_now);
+    commonlib::ArchiveWriter writer(600);
+    for(int i = 0; i < 3600; ++i)
+    {
+        writer.append(commonlib::ParsedEvent{ commonlib::EventKind::SESSION_START, 1, start + seconds(i), "s", i, 1.0 });
+    }
+    writer.finish();
+
+    commonlib::ArchiveReader reader(writer.data());
+    std::vector<commonlib::ParsedEvent> events;
+    std::vector<int> firsts;
+    while(reader.nextBlock(events, start + seconds(1500), start + seconds(2100)))
+    {
+        firsts.push_back(events.front().someSpecificData_);
+    }
+    EXPECT_EQ(firsts, (std::vector<int>{ 1200, 1800 }));
+    EXPECT_EQ(reader.skippedBlocks(), 4u);
+}
+
+/*
+* @ brief test that damaged archives are rejected
+* @ detail Procedure: Read an archive cut short at every length, one with its magic overwritten and ones whose event
+*          count is over the most a writer produces or more than the block holds
+*          Expected: std::runtime_error, never a read past the end or an allocation for the bad count
+*/
+TEST(TestArchive, damagedArchive)
+{
+    commonlib::ArchiveWriter writer;
+    for(int i = 0; i < 50; ++i)
+    {
+        writer.append(commonlib::ParsedEvent{ commonlib::EventKind::AUTH_LOGIN, 7, s_now + seconds(i), "Fred", i, 1.0 });
+    }
+    writer.finish();
+    const std::string archive = writer.data();
+
+    std::vector<commonlib::ParsedEvent> events;
+    for(std::size_t length = 1; length < archive.size(); ++length)
+    {
+        // A copy of just the prefix, so reading past it would be caught by sanitizers
+        const std::string truncated = archive.substr(0, length);
+        commonlib::ArchiveReader reader(truncated);
+        EXPECT_THROW(reader.nextBlock(events), std::runtime_error) << "length " << length;
+    }
+
+    std::string corrupt = archive;
+    corrupt[0] = 'X';
+    commonlib::ArchiveReader reader(corrupt);
+    EXPECT_THROW(reader.nextBlock(events), std::runtime_error);
+
+    for(std::uint32_t count : { std::uint32_t(0xffffffff), std::uint32_t(commonlib::ArchiveWriter::MaxBlockEvents + 1), std::uint32_t(51) })
+    {
+        corrupt = archive;
+        std::memcpy(corrupt.data() + 4, &count, sizeof(count));
+        commonlib::ArchiveReader countReader(corrupt);
+        EXPECT_THROW(countReader.nextBlock(events), std::runtime_error) << count;
+    }
+
+    EXPECT_THROW(commonlib::ArchiveWriter(0), std::invalid_argument);
+    EXPECT_THROW(commonlib::ArchiveWriter(commonlib::ArchiveWriter::MaxBlockEvents + 1), std::invalid_argument);
+}
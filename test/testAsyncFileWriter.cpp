@@ -0,0 +1,178 @@
+#include "commonlib/AsyncFileWriter.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+
+namespace
+{
+
+std::string readFile(const std::string & path)
+{
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream contents;
+    contents << in.rdbuf();
+    return contents.str();
+}
+
+// Whether the io_uring backend can be opened here, which a container's seccomp profile may forbid
+bool ioUringAvailable()
+{
+    const std::string probePath = ::testing::TempDir() + "asyncFileWriterProbe.txt";
+    bool available = true;
+    try
+    {
+        commonlib::AsyncFileWriterOptions options;
+        options.backend_ = commonlib::AsyncFileWriterOptions::IO_URING;
+        commonlib::openAsyncFileWriter(probePath, options);
+    }
+    catch(const std::system_error &)
+    {
+        available = false;
+    }
+    std::remove(probePath.c_str());
+    return available;
+}
+
+// Fill two buffers and submit them the other way round from how they were acquired
+void checkSubmissionOrder(commonlib::AsyncFileWriterOptions::Backend backend)
+{
+    const std::string path = ::testing::TempDir() + "asyncFileWriterOrder.txt";
+
+    commonlib::AsyncFileWriterOptions options;
+    options.backend_ = backend;
+    options.bufferSize_ = commonlib::AsyncFileWriter::BlockSize;
+    options.bufferCount_ = 2;
+
+    {
+        auto writer = commonlib::openAsyncFileWriter(path, options);
+        for(int round = 0; round < 3; ++round)
+        {
+            commonlib::AsyncFileWriter::Buffer * first = writer->acquire();
+            commonlib::AsyncFileWriter::Buffer * second = writer->acquire();
+            first->size_ = std::snprintf(first->data_, first->capacity_, "acquired first %d\n", round);
+            second->size_ = std::snprintf(second->data_, second->capacity_, "acquired second %d\n", round);
+            writer->submit(second);
+            writer->submit(first);
+        }
+        writer->close();
+    }
+
+    EXPECT_EQ(readFile(path), "acquired second 0\nacquired first 0\nacquired second 1\nacquired first 1\n"
+                              "acquired second 2\nacquired first 2\n");
+    std::remove(path.c_str());
+}
+
+// Write a few buffers worth of numbered lines, flushing part way through, and check the file holds exactly that
+void checkRoundTrip(commonlib::AsyncFileWriterOptions::Backend backend, bool directIO)
+{
+    const std::string path = ::testing::TempDir() + "asyncFileWriter.txt";
+
+    commonlib::AsyncFileWriterOptions options;
+    options.backend_ = backend;
+    options.directIO_ = directIO;
+    options.bufferSize_ = commonlib::AsyncFileWriter::BlockSize;
+    options.bufferCount_ = 3;
+
+    std::string expected;
+    {
+        auto writer = commonlib::openAsyncFileWriter(path, options);
+        commonlib::AsyncFileSink sink(*writer);
+        for(int i = 0; i < 5000; ++i)
+        {
+            std::string line = "Line number " + std::to_string(i) + "\n";
+            sink.append(line);
+            expected += line;
+            if(i == 1234)
+            {
+                sink.flush();
+            }
+        }
+        sink.close();
+    }
+
+    EXPECT_EQ(expected, readFile(path));
+    std::remove(path.c_str());
+}
+
+} // end anonymous namespace
+
+/*
+* @ brief test that the io_uring backend writes everything in order
+* @ detail Procedure: Write many small appends spanning several buffers, with a flush in the middle, with and without O_DIRECT
+*          Expected: The file holds exactly what was appended. Skipped where io_uring is not allowed
+*/
+TEST(TestAsyncFileWriter, ioUringRoundTrip)
+{
+    if(!ioUringAvailable())
+    {
+        GTEST_SKIP() << "io_uring is not available";
+    }
+
+    checkRoundTrip(commonlib::AsyncFileWriterOptions::IO_URING, false);
+    checkRoundTrip(commonlib::AsyncFileWriterOptions::IO_URING, true);
+}
+
+/*
+* @ brief test that the pwritev backend writes everything in order
+* @ detail Procedure: Write many small appends spanning several buffers, with a flush in the middle, with and without O_DIRECT
+*          Expected: The file holds exactly what was appended
+*/
+TEST(TestAsyncFileWriter, pwritevRoundTrip)
+{
+    checkRoundTrip(commonlib::AsyncFileWriterOptions::PWRITEV, false);
+    checkRoundTrip(commonlib::AsyncFileWriterOptions::PWRITEV, true);
+}
+
+/*
+* @ brief test that buffers are written in the order they are submitted, not the order they were acquired
+* @ detail Procedure: With each backend, acquire two buffers, fill them and submit the second first, three times over
+*          Expected: The file holds each second buffer before its first. io_uring is skipped where it is not allowed
+*/
+TEST(TestAsyncFileWriter, submissionOrder)
+{
+    checkSubmissionOrder(commonlib::AsyncFileWriterOptions::PWRITEV);
+    if(ioUringAvailable())
+    {
+        checkSubmissionOrder(commonlib::AsyncFileWriterOptions::IO_URING);
+    }
+}
+
+/*
+* @ brief test that acquiring with every buffer held fails rather than waiting forever
+* @ detail Procedure: With each backend, acquire all of its buffers, try for one more, then submit one and try again
+*          Expected: std::logic_error while all are held, a buffer once one is submitted. io_uring is skipped where it
+*          is not allowed
+*/
+TEST(TestAsyncFileWriter, acquireWithEveryBufferHeld)
+{
+    const std::string path = ::testing::TempDir() + "asyncFileWriterHeld.txt";
+    for(auto backend : { commonlib::AsyncFileWriterOptions::PWRITEV, commonlib::AsyncFileWriterOptions::IO_URING })
+    {
+        if(backend == commonlib::AsyncFileWriterOptions::IO_URING && !ioUringAvailable())
+        {
+            continue;
+        }
+
+        commonlib::AsyncFileWriterOptions options;
+        options.backend_ = backend;
+        options.bufferSize_ = commonlib::AsyncFileWriter::BlockSize;
+        options.bufferCount_ = 2;
+        auto writer = commonlib::openAsyncFileWriter(path, options);
+
+        commonlib::AsyncFileWriter::Buffer * first = writer->acquire();
+        commonlib::AsyncFileWriter::Buffer * second = writer->acquire();
+        EXPECT_THROW(writer->acquire(), std::logic_error) << writer->backendName();
+
+        first->size_ = 1;
+        first->data_[0] = 'x';
+        writer->submit(first);
+        commonlib::AsyncFileWriter::Buffer * third = writer->acquire();
+        EXPECT_NE(third, second);
+        writer->close(second);
+    }
+    std::remove(path.c_str());
+}
@@ -0,0 +1,143 @@
+#include "commonlib/Clock.hpp"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+
+namespace
+{
+
+using namespace std::chrono;
+
+static_assert(commonlib::TimestampClock<commonlib::SystemClock>);
+static_assert(commonlib::TimestampClock<commonlib::TscClock>);
+static_assert(commonlib::TimestampClock<commonlib::CoarseClock>);
+
+// Stamps from clock taken for the given time, checked against system_clock and against going backwards
+template <class Clock>
+void expectTracksSystemClock(Clock & clock, milliseconds runFor, milliseconds tolerance)
+{
+    auto previous = clock.now();
+    const auto end = steady_clock::now() + runFor;
+    while(steady_clock::now() < end)
+    {
+        const auto before = system_clock::now();
+        const auto stamp = clock.now();
+        const auto after = system_clock::now();
+
+        ASSERT_GE(stamp, previous);
+        ASSERT_GE(stamp, before - tolerance);
+        ASSERT_LE(stamp, after + tolerance);
+        previous = stamp;
+    }
+}
+
+} // end anonymous namespace
+
+/*
+* @ brief test the TSC clock against system_clock
+* @ detail Procedure: Stamp continuously for 200ms with a clock resyncing every 10ms
+*          Expected: Every stamp within a millisecond of system_clock and none before the one before it
+*/
+TEST(TestClock, tscTracksSystemClock)
+{
+    if(!commonlib::TscClock::supported())
+    {
+        GTEST_SKIP() << "No invariant TSC";
+    }
+
+    commonlib::TscClock clock(milliseconds(10));
+    EXPECT_GT(clock.ticksPerSecond(), 1e8);
+    expectTracksSystemClock(clock, milliseconds(200), milliseconds(1));
+}
+
+/*
+* @ brief test the TSC clock with counters of different rates
+* @ detail Procedure: Stamp for 100ms from clocks resyncing every millisecond whose counter is steady_clock scaled to
+*          3 GHz and to 500 MHz, so the first stamp after each resync reads the counter before the resync does
+*          Expected: Every stamp within a millisecond of system_clock and none before the one before it
+*/
+TEST(TestClock, tscInjectedCounter)
+{
+    for(double ticksPerNanosecond : { 3.0, 0.5 })
+    {
+        auto counter = [ticksPerNanosecond]
+        {
+            const auto nanoseconds = duration_cast<std::chrono::nanoseconds>(steady_clock::now().time_since_epoch()).count();
+            return static_cast<std::uint64_t>(static_cast<double>(nanoseconds) * ticksPerNanosecond);
+        };
+        commonlib::TscClock clock(milliseconds(1), [] { return system_clock::now(); }, counter);
+        EXPECT_NEAR(clock.ticksPerSecond(), ticksPerNanosecond * 1e9, ticksPerNanosecond * 1e7);
+        expectTracksSystemClock(clock, milliseconds(100), milliseconds(1));
+    }
+}
+
+/*
+* @ brief test that the TSC clock holds when wall time is put back by more than a resync interval
+* @ detail Procedure: Stamp for 20ms with a clock resyncing every millisecond, put its wall time back 10ms, then
+*          stamp through several more resyncs
+*          Expected: No stamp before the one before it, and stamps move on again once the wall time catches up
+*/
+TEST(TestClock, tscHoldsAcrossBackwardStep)
+{
+    if(!commonlib::TscClock::supported())
+    {
+        GTEST_SKIP() << "No invariant TSC";
+    }
+
+    std::atomic<system_clock::duration> offset{ system_clock::duration::zero() };
+    commonlib::TscClock clock(milliseconds(1), [&offset] { return system_clock::now() - offset.load(); });
+
+    auto stampFor = [&clock](milliseconds runFor, system_clock::time_point previous)
+    {
+        const auto end = steady_clock::now() + runFor;
+        while(steady_clock::now() < end)
+        {
+            const auto stamp = clock.now();
+            EXPECT_GE(stamp, previous);
+            if(stamp < previous)
+            {
+                break;
+            }
+            previous = stamp;
+        }
+        return previous;
+    };
+
+    auto last = stampFor(milliseconds(20), clock.now());
+    offset = milliseconds(10);
+    last = stampFor(milliseconds(30), last);
+    EXPECT_GT(last, system_clock::now() - milliseconds(15));
+}
+
+/*
+* @ brief test the coarse clock against system_clock
+* @ detail Procedure: Stamp continuously for 200ms from a clock updated every 100us, then sleep and stamp again
+*          Expected: Stamps lag system_clock by no more than scheduling allows, never go backwards, and move on
+*/
+TEST(TestClock, coarseTracksSystemClock)
+{
+    commonlib::CoarseClock clock(microseconds(100));
+    // Generous, since the updater may wait behind this thread for a whole time slice on a busy machine
+    expectTracksSystemClock(clock, milliseconds(200), milliseconds(50));
+
+    const auto before = clock.now();
+    std::this_thread::sleep_for(milliseconds(20));
+    EXPECT_GE(clock.now() - before, milliseconds(10));
+}
+
+/*
+* @ brief test clock argument checks
+* @ detail Procedure: Make clocks with zero intervals
+*          Expected: std::invalid_argument
+*/
+TEST(TestClock, badArguments)
+{
+    EXPECT_THROW(commonlib::CoarseClock(microseconds(0)), std::invalid_argument);
+    if(commonlib::TscClock::supported())
+    {
+        EXPECT_THROW(commonlib::TscClock(nanoseconds(0)), std::invalid_argument);
+    }
+}
@@ -0,0 +1,158 @@
+#include "classiclib/Events.hpp"
+#include "commonlib/DedupFilter.hpp"
+#include "commonlib/Hash.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+
+namespace
+{
+
+const auto s_start = std::chrono::steady_clock::time_point{} + std::chrono::hours(1);
+const auto s_window = std::chrono::seconds(10);
+
+commonlib::DedupFilter makeFilter(std::size_t expectedEvents, double falsePositiveRate = 0.01)
+{
+    commonlib::DedupFilterOptions options;
+    options.expectedEventsPerWindow_ = expectedEvents;
+    options.falsePositiveRate_ = falsePositiveRate;
+    options.window_ = s_window;
+    return commonlib::DedupFilter(options);
+}
+
+} // end anonymous namespace
+
+/*
+* @ brief test that a repeated fingerprint is dropped and a new one is not
+* @ detail Procedure: Admit the same fingerprint twice, then another one
+*          Expected: Only the repeat is rejected
+*/
+TEST(TestDedupFilter, dropsRepeats)
+{
+    auto filter = makeFilter(1000);
+
+    EXPECT_TRUE(filter.admit(1, s_start));
+    EXPECT_FALSE(filter.admit(1, s_start));
+    EXPECT_TRUE(filter.admit(2, s_start));
+}
+
+/*
+* @ brief test that the false positive rate stays near the configured one
+* @ detail Procedure: Admit as many distinct fingerprints as the filter is sized for
+*          Expected: Under twice the configured rate are wrongly rejected
+*/
+TEST(TestDedupFilter, falsePositiveRate)
+{
+    const std::size_t events = 200000;
+    auto filter = makeFilter(events);
+
+    std::size_t rejected = 0;
+    for(std::uint64_t i = 0; i < events; ++i)
+    {
+        rejected += filter.admit(commonlib::mixHash(i), s_start) ? 0 : 1;
+    }
+    EXPECT_LT(static_cast<double>(rejected) / events, 0.02);
+}
+
+/*
+* @ brief test the false positive rate at a target low enough to need more than seven bits per fingerprint
+* @ detail Procedure: Admit 400000 distinct fingerprints into a filter sized for them at a rate of 1 in 10000
+*          Expected: Under twice the configured rate are wrongly rejected
+*/
+TEST(TestDedupFilter, lowFalsePositiveRate)
+{
+    const std::size_t events = 400000;
+    auto filter = makeFilter(events, 0.0001);
+
+    std::size_t rejected = 0;
+    for(std::uint64_t i = 0; i < events; ++i)
+    {
+        rejected += filter.admit(commonlib::mixHash(i), s_start) ? 0 : 1;
+    }
+    EXPECT_LT(static_cast<double>(rejected) / events, 0.0002);
+}
+
+/*
+* @ brief test that the filter can be shared between threads
+* @ detail Procedure: Several threads admit their own distinct fingerprints, then all of them again
+*          Expected: Few of the first pass are rejected, and every one of the second pass is
+*/
+TEST(TestDedupFilter, sharedBetweenThreads)
+{
+    const std::uint64_t threads = 4;
+    const std::uint64_t eventsPerThread = 20000;
+    auto filter = makeFilter(threads * eventsPerThread);
+
+    std::atomic<std::size_t> rejectedFirst{ 0 };
+    std::atomic<std::size_t> admittedSecond{ 0 };
+    std::vector<std::thread> workers;
+    for(std::uint64_t thread = 0; thread < threads; ++thread)
+    {
+        workers.emplace_back([&, thread]
+        {
+            for(std::uint64_t i = 0; i < eventsPerThread; ++i)
+            {
+                rejectedFirst += filter.admit(thread * eventsPerThread + i, s_start) ? 0 : 1;
+            }
+        });
+    }
+    for(auto & worker : workers)
+    {
+        worker.join();
+    }
+
+    for(std::uint64_t i = 0; i < threads * eventsPerThread; ++i)
+    {
+        admittedSecond += filter.admit(i, s_start) ? 1 : 0;
+    }
+
+    EXPECT_LT(rejectedFirst.load(), threads * eventsPerThread / 50);
+    EXPECT_EQ(0u, admittedSecond.load());
+}
+
+/*
+* @ brief test that fingerprints are forgotten once they age out
+* @ detail Procedure: Admit a fingerprint, retry it within a window, then again after more than two quiet windows
+*          Expected: The retry is rejected, the late one is admitted
+*/
+TEST(TestDedupFilter, forgetsAfterWindows)
+{
+    auto filter = makeFilter(1000);
+
+    EXPECT_TRUE(filter.admit(7, s_start));
+    EXPECT_FALSE(filter.admit(7, s_start + s_window / 2));
+    EXPECT_TRUE(filter.admit(7, s_start + 3 * s_window));
+}
+
+/*
+* @ brief test that fingerprints identify redeliveries of an event in every library
+* @ detail Procedure: Fingerprint two copies of an event, and one differing only in its specific data
+*          Expected: The copies match, the other one does not
+*/
+TEST(TestDedupFilter, fingerprints)
+{
+    const auto now = std::chrono::system_clock::now();
+
+    classiclib::AuthLoginEvent classicEvent{ 6789, now, "Fred", 42 };
+    classiclib::AuthLoginEvent classicCopy{ 6789, now, "Fred", 42 };
+    classiclib::AuthLoginEvent classicOther{ 6789, now, "Fred", 43 };
+    EXPECT_EQ(classiclib::fingerprint(&classicEvent), classiclib::fingerprint(&classicCopy));
+    EXPECT_NE(classiclib::fingerprint(&classicEvent), classiclib::fingerprint(&classicOther));
+
+    purecomplib::Event pureCompEvent{ purecomplib::SessionEvent{ purecomplib::SessionStartEvent{ 9876, now, "session123", 42 } } };
+    purecomplib::Event pureCompCopy{ pureCompEvent };
+    purecomplib::Event pureCompOther{ purecomplib::SessionEvent{ purecomplib::SessionEndEvent{ 9876, now, "session123", 42 } } };
+    EXPECT_EQ(purecomplib::fingerprint(&pureCompEvent), purecomplib::fingerprint(&pureCompCopy));
+    EXPECT_NE(purecomplib::fingerprint(&pureCompEvent), purecomplib::fingerprint(&pureCompOther));
+
+    templatecastlib::SessionEndEvent templateCastEvent{ 9876, now, "session123", 42 };
+    templatecastlib::SessionEndEvent templateCastCopy{ 9876, now, "session123", 42 };
+    templatecastlib::SessionEndEvent templateCastOther{ 9876, now, "session124", 42 };
+    EXPECT_EQ(templatecastlib::fingerprint(&templateCastEvent), templatecastlib::fingerprint(&templateCastCopy));
+    EXPECT_NE(templatecastlib::fingerprint(&templateCastEvent), templatecastlib::fingerprint(&templateCastOther));
+}
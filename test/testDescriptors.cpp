@@ -0,0 +1,105 @@
+#include "classiclib/Events.hpp"
+#include "commonlib/FieldDescriptor.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+
+
+namespace
+{
+
+const auto s_now = std::chrono::system_clock::now();
+
+// Format every event both ways and compare
+template <class Event>
+void expectSameAsHandler(const std::unique_ptr<Event> (&events)[4], std::string (*format)(const Event *))
+{
+    for(const auto & event : events)
+    {
+        // Found by argument dependent lookup in the event's library
+        std::string handled;
+        handleEvent(event.get(), handled);
+        EXPECT_EQ(format(event.get()), handled);
+    }
+}
+
+} // end anonymous namespace
+
+/*
+* @ brief test that the table driven formatter writes what each library's handler writes
+* @ detail Procedure: Format one event of every type from every library with formatDescribed and with handleEvent
+*          Expected: Identical text
+*/
+TEST(TestDescriptors, formatMatchesHandlers)
+{
+    std::unique_ptr<classiclib::EventBase> classic[] =
+    {
+        std::make_unique<classiclib::SessionStartEvent>(9876, s_now, "session123", 42),
+        std::make_unique<classiclib::SessionEndEvent>(9876, s_now, "session123", 43),
+        std::make_unique<classiclib::AuthLoginEvent>(6789, s_now, "Fred", 44),
+        std::make_unique<classiclib::AuthLogoutEvent>(6789, s_now, "Fred", 45),
+    };
+    expectSameAsHandler<classiclib::EventBase>(classic, [](const classiclib::EventBase * event)
+    {
+        std::string formatted;
+        commonlib::formatDescribed(formatted, classiclib::describe(event));
+        return formatted;
+    });
+
+    std::unique_ptr<purecomplib::Event> purecomp[] =
+    {
+        std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{ purecomplib::SessionStartEvent{ 9876, s_now, "session123", 42 } }),
+        std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{ purecomplib::SessionEndEvent{ 9876, s_now, "session123", 43 } }),
+        std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{ purecomplib::AuthLoginEvent{ 6789, s_now, "Fred", 44 } }),
+        std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{ purecomplib::AuthLogoutEvent{ 6789, s_now, "Fred", 45 } }),
+    };
+    expectSameAsHandler<purecomplib::Event>(purecomp, [](const purecomplib::Event * event)
+    {
+        std::string formatted;
+        commonlib::formatDescribed(formatted, purecomplib::describe(event));
+        return formatted;
+    });
+
+    std::unique_ptr<templatecastlib::Event> templatecast[] =
+    {
+        std::make_unique<templatecastlib::SessionStartEvent>(9876, s_now, "session123", 42),
+        std::make_unique<templatecastlib::SessionEndEvent>(9876, s_now, "session123", 43),
+        std::make_unique<templatecastlib::AuthLoginEvent>(6789, s_now, "Fred", 44),
+        std::make_unique<templatecastlib::AuthLogoutEvent>(6789, s_now, "Fred", 45),
+    };
+    expectSameAsHandler<templatecastlib::Event>(templatecast, [](const templatecastlib::Event * event)
+    {
+        std::string formatted;
+        commonlib::formatDescribed(formatted, templatecastlib::describe(event));
+        return formatted;
+    });
+}
+
+/*
+* @ brief test the binary encoding of an event
+* @ detail Procedure: Encode a classiclib and a purecomplib auth login with the same data
+*          Expected: Kind byte, pid, nanosecond timestamp, length prefixed user id and specific data, the same for both
+*/
+TEST(TestDescriptors, encode)
+{
+    const auto timestamp = std::chrono::system_clock::time_point(std::chrono::nanoseconds(0x0102030405060708));
+    classiclib::AuthLoginEvent classic{ 0x1234, timestamp, "Fred", 0x0a0b0c0d };
+    purecomplib::Event purecomp{ purecomplib::AuthEvent{ purecomplib::AuthLoginEvent{ 0x1234, timestamp, "Fred", 0x0a0b0c0d } } };
+
+    std::string encoded;
+    commonlib::encodeDescribed(encoded, classiclib::describe(&classic));
+
+    const std::string expected("\x02"
+                               "\x34\x12"
+                               "\x08\x07\x06\x05\x04\x03\x02\x01"
+                               "\x04\x00\x00\x00" "Fred"
+                               "\x0d\x0c\x0b\x0a", 1 + 2 + 8 + 4 + 4 + 4);
+    EXPECT_EQ(encoded, expected);
+
+    std::string encodedPureComp;
+    commonlib::encodeDescribed(encodedPureComp, purecomplib::describe(&purecomp));
+    EXPECT_EQ(encodedPureComp, expected);
+}
@@ -0,0 +1,169 @@
+#include "alloctracklib/AllocTracker.hpp"
+#include "classiclib/Events.hpp"
+#include "commonlib/Json.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+
+namespace
+{
+
+using namespace std::chrono;
+
+const system_clock::time_point s_timestamp = sys_days{ year(2024) / 1 / 2 } + hours(3) + minutes(4) + seconds(5) + nanoseconds(123456789);
+
+// Escape one byte at a time, to check the vectorized version against
+std::string referenceEscape(std::string_view text)
+{
+    std::string escaped = "\"";
+    for(char c : text)
+    {
+        const auto byte = static_cast<unsigned char>(c);
+        switch(c)
+        {
+            case '"':  escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\b': escaped += "\\b"; break;
+            case '\f': escaped += "\\f"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\r': escaped += "\\r"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if(byte < 0x20)
+                {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", byte);
+                    escaped += buffer;
+                }
+                else
+                {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped + "\"";
+}
+
+} // end anonymous namespace
+
+/*
+* @ brief test the JSON line each library writes for an event
+* @ detail Procedure: Write a session start from each library and an auth logout from one
+*          Expected: One object per line with the type, pid, UTC timestamp to the microsecond, id and specific data
+*/
+TEST(TestJson, eventLines)
+{
+    std::string classic;
+    classiclib::handleEventJson(std::make_unique<classiclib::SessionStartEvent>(9876, s_timestamp, "session123", 42).get(), classic);
+    EXPECT_EQ(classic, "{\"type\":\"SessionStartEvent\",\"pid\":9876,\"timestamp\":\"2024-01-02T03:04:05.123456Z\","
+                       "\"sessionId\":\"session123\",\"someSpecificData\":42}\n");
+
+    std::string purecomp;
+    purecomplib::Event purecompEvent{ purecomplib::SessionEvent{ purecomplib::SessionStartEvent{ 9876, s_timestamp, "session123", 42 } } };
+    purecomplib::handleEventJson(&purecompEvent, purecomp);
+    EXPECT_EQ(purecomp, classic);
+
+    std::string templatecast;
+    templatecastlib::handleEventJson(std::make_unique<templatecastlib::AuthLogoutEvent>(-1, s_timestamp - hours(4), "Fred", -7).get(), templatecast);
+    EXPECT_EQ(templatecast, "{\"type\":\"AuthLogoutEvent\",\"pid\":-1,\"timestamp\":\"2024-01-01T23:04:05.123456Z\","
+                            "\"userId\":\"Fred\",\"someSpecificData\":-7}\n");
+}
+
+/*
+* @ brief test that the three libraries write the same JSON line for the same event
+* @ detail Procedure: Write an event of each type with the same fields from each library
+*          Expected: The three libraries' lines are identical, specific data included
+*/
+TEST(TestJson, sameLinesAcrossLibraries)
+{
+    std::string classic;
+    classiclib::handleEventJson(std::make_unique<classiclib::SessionStartEvent>(1, s_timestamp, "s", 10).get(), classic);
+    classiclib::handleEventJson(std::make_unique<classiclib::SessionEndEvent>(2, s_timestamp, "s", 20).get(), classic);
+    classiclib::handleEventJson(std::make_unique<classiclib::AuthLoginEvent>(3, s_timestamp, "Fred", 30).get(), classic);
+    classiclib::handleEventJson(std::make_unique<classiclib::AuthLogoutEvent>(4, s_timestamp, "Fred", 40).get(), classic);
+
+    std::string purecomp;
+    purecomplib::Event purecompEvents[] =
+    {
+        purecomplib::SessionEvent{ purecomplib::SessionStartEvent{ 1, s_timestamp, "s", 10 } },
+        purecomplib::SessionEvent{ purecomplib::SessionEndEvent{ 2, s_timestamp, "s", 20 } },
+        purecomplib::AuthEvent{ purecomplib::AuthLoginEvent{ 3, s_timestamp, "Fred", 30 } },
+        purecomplib::AuthEvent{ purecomplib::AuthLogoutEvent{ 4, s_timestamp, "Fred", 40 } },
+    };
+    for(const auto & event : purecompEvents)
+    {
+        purecomplib::handleEventJson(&event, purecomp);
+    }
+
+    std::string templatecast;
+    templatecastlib::handleEventJson(std::make_unique<templatecastlib::SessionStartEvent>(1, s_timestamp, "s", 10).get(), templatecast);
+    templatecastlib::handleEventJson(std::make_unique<templatecastlib::SessionEndEvent>(2, s_timestamp, "s", 20).get(), templatecast);
+    templatecastlib::handleEventJson(std::make_unique<templatecastlib::AuthLoginEvent>(3, s_timestamp, "Fred", 30).get(), templatecast);
+    templatecastlib::handleEventJson(std::make_unique<templatecastlib::AuthLogoutEvent>(4, s_timestamp, "Fred", 40).get(), templatecast);
+
+    EXPECT_EQ(purecomp, classic);
+    EXPECT_EQ(templatecast, classic);
+    EXPECT_NE(classic.find("\"userId\":\"Fred\",\"someSpecificData\":40}\n"), std::string::npos);
+}
+
+/*
+* @ brief test string escaping against a byte at a time reference
+* @ detail Procedure: Escape strings of every length up to 40 with each kind of special character at every position
+*          Expected: The same output as the reference, and UTF-8 passes through
+*/
+TEST(TestJson, escaping)
+{
+    const char specials[] = { '"', '\\', '\n', '\t', '\x01', '\x1f', '\b', '\f', '\r' };
+    for(std::size_t length = 0; length <= 40; ++length)
+    {
+        const std::string clean(length, 'x');
+        std::string escaped;
+        commonlib::appendJsonString(escaped, clean);
+        EXPECT_EQ(escaped, "\"" + clean + "\"");
+
+        for(std::size_t position = 0; position < length; ++position)
+        {
+            for(char special : specials)
+            {
+                std::string text = clean;
+                text[position] = special;
+                text.back() = special == '"' ? '\\' : '"';
+
+                escaped.clear();
+                commonlib::appendJsonString(escaped, text);
+                EXPECT_EQ(escaped, referenceEscape(text)) << "length " << length << " position " << position;
+            }
+        }
+    }
+
+    std::string utf8;
+    commonlib::appendJsonString(utf8, "caf\xc3\xa9 \x7f");
+    EXPECT_EQ(utf8, "\"caf\xc3\xa9 \x7f\"");
+}
+
+/*
+* @ brief test that JSON output into a reserved buffer does not allocate
+* @ detail Procedure: Format events from each library into a BufferSink with capacity reserved up front
+*          Expected: No allocations
+*/
+TEST(TestJson, preallocatedOutput)
+{
+    auto classic = std::make_unique<classiclib::AuthLoginEvent>(6789, s_timestamp, "a user id longer than the small string buffer", 42);
+    purecomplib::Event purecomp{ purecomplib::AuthEvent{ purecomplib::AuthLoginEvent{ 6789, s_timestamp, "Fred", 42 } } };
+    auto templatecast = std::make_unique<templatecastlib::SessionEndEvent>(9876, s_timestamp, "session\t123", 42);
+
+    commonlib::BufferSink sink(4096);
+    alloctracklib::AllocScope scope;
+    for(int i = 0; i < 10; ++i)
+    {
+        classiclib::handleEventJson(classic.get(), sink);
+        purecomplib::handleEventJson(&purecomp, sink);
+        templatecastlib::handleEventJson(templatecast.get(), sink);
+    }
+    EXPECT_EQ(scope.stats().allocations_, 0);
+    EXPECT_NE(sink.buffer().find("\"sessionId\":\"session\\t123\""), std::string::npos);
+}
@@ -0,0 +1,245 @@
+#include "LatencyHistogram.hpp"
+#include "Workload.hpp"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+using commonlib::EventKind;
+
+const auto s_start = std::chrono::steady_clock::time_point{} + std::chrono::hours(1);
+
+// The upper bound of the bucket a value falls in: the median of it and a larger value
+std::uint64_t bucketUpperBound(std::uint64_t value)
+{
+    loadgen::LatencyHistogram histogram;
+    histogram.record(value);
+    histogram.record(std::numeric_limits<std::uint64_t>::max());
+    return histogram.percentile(0.5);
+}
+
+bool sameSpec(const loadgen::EventSpec & lhs, const loadgen::EventSpec & rhs)
+{
+    return lhs.kind_ == rhs.kind_ && lhs.pid_ == rhs.pid_ && lhs.someSpecificData_ == rhs.someSpecificData_ && lhs.id() == rhs.id();
+}
+
+} // end anonymous namespace
+
+/*
+* @ brief test the bucket boundaries of the latency histogram
+* @ detail Procedure: Find the bucket upper bound of small values, of powers of two and of the values either side of a
+*          bucket's bounds, up to the largest 64 bit value
+*          Expected: Values below 64 are exact, above that a bucket spans 1/32 of its power of two and ends just
+*          before the next one starts
+*/
+TEST(TestLoadgen, histogramBuckets)
+{
+    for(std::uint64_t value = 0; value < 64; ++value)
+    {
+        EXPECT_EQ(bucketUpperBound(value), value);
+    }
+    for(int power = 6; power < 64; ++power)
+    {
+        const std::uint64_t low = std::uint64_t(1) << power;
+        const std::uint64_t high = low + (low >> 5) - 1;
+        EXPECT_EQ(bucketUpperBound(low), high) << power;
+        EXPECT_EQ(bucketUpperBound(high), high) << power;
+        EXPECT_EQ(bucketUpperBound(high + 1), high + (low >> 5)) << power;
+        EXPECT_EQ(bucketUpperBound(low - 1), low - 1) << power;
+    }
+
+    loadgen::LatencyHistogram histogram;
+    histogram.record(std::numeric_limits<std::uint64_t>::max());
+    EXPECT_EQ(histogram.count(), 1u);
+    EXPECT_EQ(histogram.percentile(1.0), std::numeric_limits<std::uint64_t>::max());
+}
+
+/*
+* @ brief test percentiles against a sorted reference
+* @ detail Procedure: Record 100000 log-uniform values from 1ns to 10s, and look up percentiles from the median to
+*          the maximum
+*          Expected: Each is at least the exact percentile of the sorted values and within 1/32 above it; the maximum
+*          is exact
+*/
+TEST(TestLoadgen, histogramPercentiles)
+{
+    std::mt19937_64 random(7);
+    std::uniform_real_distribution<double> exponent(0.0, std::log(1e10));
+
+    loadgen::LatencyHistogram histogram;
+    std::vector<std::uint64_t> values(100000);
+    for(auto & value : values)
+    {
+        value = static_cast<std::uint64_t>(std::exp(exponent(random)));
+        histogram.record(value);
+    }
+    std::sort(values.begin(), values.end());
+
+    for(std::size_t tenThousandths : { 5000, 9000, 9900, 9990, 9999 })
+    {
+        const double fraction = static_cast<double>(tenThousandths) / 10000;
+        const std::uint64_t exact = values[(tenThousandths * values.size() + 9999) / 10000 - 1];
+        const std::uint64_t reported = histogram.percentile(fraction);
+        EXPECT_GE(reported, exact) << fraction;
+        EXPECT_LE(reported, exact + exact / 32) << fraction;
+    }
+    EXPECT_EQ(histogram.percentile(1.0), values.back());
+    EXPECT_EQ(histogram.max(), values.back());
+    EXPECT_EQ(histogram.count(), values.size());
+
+    histogram.reset();
+    EXPECT_EQ(histogram.count(), 0u);
+    EXPECT_EQ(histogram.percentile(0.5), 0u);
+}
+
+/*
+* @ brief test percentiles that fall between two values on small distributions with exact buckets
+* @ detail Procedure: Record 999 tens, a 20 and a 30, then separately the values 0 to 99 once each
+*          Expected: Each percentile is the smallest value that at least that fraction of values are at or below:
+*          p99.9 of 1001 values is the 1000th, and p7 of 100 is the 7th
+*/
+TEST(TestLoadgen, histogramPercentileRounding)
+{
+    loadgen::LatencyHistogram tail;
+    for(int i = 0; i < 999; ++i)
+    {
+        tail.record(10);
+    }
+    tail.record(20);
+    tail.record(30);
+    EXPECT_EQ(tail.percentile(0.5), 10u);
+    EXPECT_EQ(tail.percentile(0.998), 10u);
+    EXPECT_EQ(tail.percentile(0.999), 20u);
+    EXPECT_EQ(tail.percentile(0.9995), 30u);
+    EXPECT_EQ(tail.percentile(1.0), 30u);
+
+    loadgen::LatencyHistogram uniform;
+    for(std::uint64_t value = 0; value < 100; ++value)
+    {
+        uniform.record(value);
+    }
+    EXPECT_EQ(uniform.percentile(0.0), 0u);
+    EXPECT_EQ(uniform.percentile(0.07), 6u);
+    EXPECT_EQ(uniform.percentile(0.075), 7u);
+    EXPECT_EQ(uniform.percentile(0.5), 49u);
+    EXPECT_EQ(uniform.percentile(0.64), 63u);
+}
+
+/*
+* @ brief test the latency recorded for events sent behind schedule
+* @ detail Procedure: Record one event sent 10ms after it was due, then a run of 100 events due every millisecond
+*          where the first takes 100ms and the rest, sent as soon as the one before is done, take 1us each
+*          Expected: The corrected latency counts from when each event was due, so the late event shows 10ms plus its
+*          service time and the stall shows in the median of the run; the uncorrected latency is the service time
+*/
+TEST(TestLoadgen, coordinatedOmission)
+{
+    loadgen::LatencyHistogram corrected;
+    loadgen::LatencyHistogram uncorrected;
+    loadgen::recordDispatch(corrected, uncorrected, s_start, s_start + std::chrono::milliseconds(10),
+                            s_start + std::chrono::milliseconds(10) + std::chrono::microseconds(2));
+    EXPECT_EQ(corrected.max(), 10002000u);
+    EXPECT_EQ(uncorrected.max(), 2000u);
+
+    corrected.reset();
+    uncorrected.reset();
+    auto sent = s_start;
+    for(int i = 0; i < 100; ++i)
+    {
+        const auto due = s_start + std::chrono::milliseconds(i);
+        sent = std::max(sent, due);
+        const auto done = sent + (i == 0 ? std::chrono::microseconds(100000) : std::chrono::microseconds(1));
+        loadgen::recordDispatch(corrected, uncorrected, due, sent, done);
+        sent = done;
+    }
+
+    // The event due at 50ms is done just after 100ms
+    EXPECT_GE(corrected.percentile(0.5), 50000000u);
+    EXPECT_LE(corrected.percentile(0.5), 52000000u);
+    EXPECT_EQ(corrected.max(), 100000000u);
+    EXPECT_GE(uncorrected.percentile(0.99), 1000u);
+    EXPECT_LE(uncorrected.percentile(0.99), 1000u + 1000u / 32);
+    EXPECT_EQ(uncorrected.max(), 100000000u);
+}
+
+/*
+* @ brief test that the workload is a function of its seed
+* @ detail Procedure: Generate 50000 events twice with the same seed and once with another
+*          Expected: The same seed gives the same events, the other seed a different stream
+*/
+TEST(TestLoadgen, workloadDeterminism)
+{
+    loadgen::WorkloadOptions options;
+    options.concurrentSessions_ = 1000;
+    loadgen::Workload first(options);
+    loadgen::Workload second(options);
+    options.seed_ = 43;
+    loadgen::Workload other(options);
+
+    std::size_t differences = 0;
+    for(int i = 0; i < 50000; ++i)
+    {
+        const loadgen::EventSpec spec = first.next();
+        ASSERT_TRUE(sameSpec(spec, second.next())) << i;
+        differences += sameSpec(spec, other.next()) ? 0 : 1;
+    }
+    EXPECT_GT(differences, 25000u);
+}
+
+/*
+* @ brief test the mix of events the workload produces
+* @ detail Procedure: Generate 200000 events from 1000 concurrent sessions on 16 processes, counting kinds and
+*          tracking each session from its start to its end
+*          Expected: The first 1000 are logins; afterwards logins and logouts keep about 1000 sessions open; every session
+*          ends after it starts, a session is never ended twice, and pids stay in the 16 from 1000
+*/
+TEST(TestLoadgen, workloadMix)
+{
+    loadgen::WorkloadOptions options;
+    options.concurrentSessions_ = 1000;
+    options.processes_ = 16;
+    loadgen::Workload workload(options);
+
+    std::map<EventKind, std::size_t> kinds;
+    std::map<std::string, short> started;
+    for(int i = 0; i < 200000; ++i)
+    {
+        const loadgen::EventSpec spec = workload.next();
+        ++kinds[spec.kind_];
+        ASSERT_GE(spec.pid_, 1000);
+        ASSERT_LT(spec.pid_, 1016);
+        if(i < 1000)
+        {
+            ASSERT_EQ(spec.kind_, EventKind::AUTH_LOGIN) << i;
+        }
+
+        if(spec.kind_ == EventKind::SESSION_START)
+        {
+            ASSERT_TRUE(started.emplace(std::string(spec.id()), spec.pid_).second) << spec.id();
+        }
+        else if(spec.kind_ == EventKind::SESSION_END)
+        {
+            auto session = started.find(std::string(spec.id()));
+            ASSERT_NE(session, started.end()) << spec.id();
+            EXPECT_EQ(session->second, spec.pid_);
+            started.erase(session);
+        }
+    }
+
+    // A logout leaves one fewer open until the next event replaces it
+    EXPECT_LE(kinds[EventKind::AUTH_LOGIN] - kinds[EventKind::AUTH_LOGOUT], 1000u);
+    EXPECT_GE(kinds[EventKind::AUTH_LOGIN] - kinds[EventKind::AUTH_LOGOUT], 999u);
+    EXPECT_GE(kinds[EventKind::AUTH_LOGIN], kinds[EventKind::SESSION_START]);
+    EXPECT_GE(kinds[EventKind::SESSION_START], kinds[EventKind::SESSION_END]);
+    EXPECT_GE(kinds[EventKind::SESSION_END], kinds[EventKind::AUTH_LOGOUT]);
+    EXPECT_GT(kinds[EventKind::AUTH_LOGOUT], 40000u);
+}
@@ -0,0 +1,261 @@
+#include "classiclib/Events.hpp"
+#include "commonlib/LogParser.hpp"
+#include "commonlib/MappedFile.hpp"
+#include "commonlib/Sampler.hpp"
+#include "commonlib/Timestamp.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+// Handler output only has whole seconds
+const auto s_now = std::chrono::time_point_cast<std::chrono::seconds>(std::chrono::system_clock::now());
+
+// Each library's output for its four types, with ids long enough that lines straddle the 64 byte blocks
+std::string writeAllLibraries()
+{
+    std::string text;
+
+    std::unique_ptr<classiclib::EventBase> classic[] =
+    {
+        std::make_unique<classiclib::SessionStartEvent>(9876, s_now, "session-0123456789abcdef0123456789", 1),
+        std::make_unique<classiclib::SessionEndEvent>(9876, s_now + std::chrono::hours(1), "session-0123456789abcdef0123456789", -2),
+        std::make_unique<classiclib::AuthLoginEvent>(-6789, s_now, "Fred", 3),
+        std::make_unique<classiclib::AuthLogoutEvent>(6789, s_now, "Fred", 4),
+    };
+    for(const auto & event : classic)
+    {
+        classiclib::handleEvent(event.get(), text);
+    }
+    commonlib::appendSampleWeight(text, 16.0);
+
+    std::unique_ptr<purecomplib::Event> purecomp[] =
+    {
+        std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{ purecomplib::SessionStartEvent{ 1, s_now, "s", 5 } }),
+        std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{ purecomplib::SessionEndEvent{ 2, s_now, "s", 6 } }),
+        std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{ purecomplib::AuthLoginEvent{ 3, s_now, "Barney", 7 } }),
+        std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{ purecomplib::AuthLogoutEvent{ 4, s_now, "Barney", 8 } }),
+    };
+    for(const auto & event : purecomp)
+    {
+        purecomplib::handleEvent(event.get(), text);
+    }
+
+    std::unique_ptr<templatecastlib::Event> templatecast[] =
+    {
+        std::make_unique<templatecastlib::SessionStartEvent>(5, s_now, "t", 9),
+        std::make_unique<templatecastlib::SessionEndEvent>(6, s_now, "t", 10),
+        std::make_unique<templatecastlib::AuthLoginEvent>(7, s_now, "Wilma", 11),
+        std::make_unique<templatecastlib::AuthLogoutEvent>(8, s_now, "Wilma", 12),
+    };
+    for(const auto & event : templatecast)
+    {
+        templatecastlib::handleEvent(event.get(), text);
+    }
+    return text;
+}
+
+std::vector<commonlib::ParsedEvent> parseAll(std::string_view text, commonlib::LogParser::Scan scan, std::size_t & malformed)
+{
+    commonlib::LogParser parser(text, scan);
+    std::vector<commonlib::ParsedEvent> events;
+    commonlib::ParsedEvent event;
+    while(parser.next(event))
+    {
+        events.push_back(event);
+    }
+    malformed = parser.malformed();
+    return events;
+}
+
+} // end anonymous namespace
+
+/*
+* @ brief test that the output of all three libraries is read back with every line scan
+* @ detail Procedure: Write four events from each library, parse them with each supported scan
+*          Expected: Twelve events with the types, pids, timestamps, ids, data and weight written, nothing malformed
+*/
+TEST(TestLogParser, readsAllLibraries)
+{
+    const std::string text = writeAllLibraries();
+
+    for(auto scan : { commonlib::LogParser::SCALAR, commonlib::LogParser::SSE2, commonlib::LogParser::AVX2 })
+    {
+        if(!commonlib::LogParser::supported(scan))
+        {
+            continue;
+        }
+
+        std::size_t malformed = 0;
+        auto events = parseAll(text, scan, malformed);
+        ASSERT_EQ(events.size(), 12u);
+        EXPECT_EQ(malformed, 0u);
+
+        for(std::size_t i = 0; i < events.size(); ++i)
+        {
+            EXPECT_EQ(events[i].kind_, static_cast<commonlib::EventKind>(i % 4));
+            EXPECT_EQ(events[i].someSpecificData_, i == 1 ? -2 : static_cast<int>(i + 1));
+        }
+        EXPECT_EQ(events[0].id_, "session-0123456789abcdef0123456789");
+        EXPECT_EQ(events[0].timestamp_, s_now);
+        EXPECT_EQ(events[1].timestamp_, s_now + std::chrono::hours(1));
+        EXPECT_EQ(events[2].pid_, -6789);
+        EXPECT_EQ(events[6].id_, "Barney");
+        EXPECT_EQ(events[11].pid_, 8);
+        EXPECT_DOUBLE_EQ(events[3].weight_, 16.0);
+        EXPECT_DOUBLE_EQ(events[4].weight_, 1.0);
+    }
+}
+
+/*
+* @ brief test that rebuilt events format exactly as the originals
+* @ detail Procedure: Parse the output of all libraries, rebuild each event with every library's makeEvent and format it
+*          Expected: Each library reproduces its own part of the text, and the others write the same events their way
+*/
+TEST(TestLogParser, rebuildsEvents)
+{
+    const std::string text = writeAllLibraries();
+    std::size_t malformed = 0;
+    auto events = parseAll(text, commonlib::LogParser::AUTO, malformed);
+    ASSERT_EQ(events.size(), 12u);
+
+    std::string classic;
+    std::string purecomp;
+    std::string templatecast;
+    for(std::size_t i = 0; i < events.size(); ++i)
+    {
+        auto & target = i < 4 ? classic : i < 8 ? purecomp : templatecast;
+        if(i < 4)
+        {
+            classiclib::handleEvent(classiclib::makeEvent(events[i]).get(), target);
+        }
+        else if(i < 8)
+        {
+            purecomplib::handleEvent(purecomplib::makeEvent(events[i]).get(), target);
+        }
+        else
+        {
+            templatecastlib::handleEvent(templatecastlib::makeEvent(events[i]).get(), target);
+        }
+        commonlib::appendSampleWeight(target, events[i].weight_);
+    }
+    EXPECT_EQ(classic + purecomp + templatecast, text);
+
+    std::string reformatted;
+    templatecastlib::handleEvent(templatecastlib::makeEvent(events[0]).get(), reformatted);
+    EXPECT_NE(reformatted.find("Specific data for session start event: 1\n"), std::string::npos);
+}
+
+/*
+* @ brief test that broken records are skipped without losing the ones around them
+* @ detail Procedure: Parse text with a stray line, a record cut short by the next one and a bad timestamp
+*          Expected: The good records are read and the three bad ones counted
+*/
+TEST(TestLogParser, skipsMalformed)
+{
+    const std::string text =
+        "garbage\n"
+        "PID is 1\nTimestamp is 2024-01-02 03:04:05\nSession id is a\n"
+        "PID is 2\nTimestamp is 2024-01-02 03:04:05\nUser is b\nSome specific data for auth login: 7\n"
+        "PID is 3\nTimestamp is 2024-13-02 03:04:05\nUser is c\nSome specific data for auth login: 8\n"
+        "PID is 4\nTimestamp is 2024-01-02 03:04:05\nUser is d\nSpecific data for auth logout event: 9";
+
+    std::size_t malformed = 0;
+    auto events = parseAll(text, commonlib::LogParser::AUTO, malformed);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(events[0].pid_, 2);
+    EXPECT_EQ(events[1].pid_, 4);
+    EXPECT_EQ(events[1].kind_, commonlib::EventKind::AUTH_LOGOUT);
+    EXPECT_EQ(events[1].someSpecificData_, 9);
+    // The stray line, record 1, and record 3 followed by its timestamp, id and data lines on their own
+    EXPECT_EQ(malformed, 6u);
+}
+
+/*
+* @ brief test that logs from templatecastlib builds that wrote the PID line twice still parse
+* @ detail Procedure: Parse records as the original handler wrote them, each PID line repeated, then a record whose
+*          second PID line differs
+*          Expected: The legacy records are read with nothing malformed; the differing line starts a new record
+*/
+TEST(TestLogParser, repeatedPidLine)
+{
+    // Exactly what the original templatecastlib::handleEvent wrote
+    const std::string text =
+        "PID is 5\nPID is 5\nTimestamp is 2024-01-02 03:04:05\nSession id is t\nSpecific data for session start event: 9\n"
+        "PID is 7\nPID is 7\nTimestamp is 2024-01-02 03:04:06\nUser is Wilma\nSpecific data for auth login event: 11\n";
+
+    std::size_t malformed = 0;
+    auto events = parseAll(text, commonlib::LogParser::AUTO, malformed);
+    ASSERT_EQ(events.size(), 2u);
+    EXPECT_EQ(malformed, 0u);
+    EXPECT_EQ(events[0].kind_, commonlib::EventKind::SESSION_START);
+    EXPECT_EQ(events[0].pid_, 5);
+    EXPECT_EQ(events[0].id_, "t");
+    EXPECT_EQ(events[1].kind_, commonlib::EventKind::AUTH_LOGIN);
+    EXPECT_EQ(events[1].pid_, 7);
+    EXPECT_EQ(events[1].someSpecificData_, 11);
+
+    const std::string differing =
+        "PID is 5\nPID is 6\nTimestamp is 2024-01-02 03:04:05\nSession id is t\nSpecific data for session start event: 9\n";
+    events = parseAll(differing, commonlib::LogParser::AUTO, malformed);
+    ASSERT_EQ(events.size(), 1u);
+    EXPECT_EQ(events[0].pid_, 6);
+    EXPECT_EQ(malformed, 1u);
+}
+
+/*
+* @ brief test that timestamps parse back to the time they were formatted from
+* @ detail Procedure: Format and parse times spread over ten years, then parse invalid text
+*          Expected: Each parses to a time that formats the same, invalid text is rejected
+*/
+TEST(TestLogParser, timestamps)
+{
+    for(int step = 0; step < 1000; ++step)
+    {
+        const auto time = s_now - std::chrono::hours(97) * step;
+        const std::string text(commonlib::formatLocalTimestamp(time));
+        std::chrono::system_clock::time_point parsed;
+        ASSERT_TRUE(commonlib::parseLocalTimestamp(text, parsed));
+        EXPECT_EQ(commonlib::formatLocalTimestamp(parsed), text);
+
+        // Exact except in the hour that repeats when daylight saving ends
+        EXPECT_LE(std::chrono::abs(parsed - time), std::chrono::hours(1));
+    }
+
+    std::chrono::system_clock::time_point parsed;
+    EXPECT_FALSE(commonlib::parseLocalTimestamp("2024-02-30 00:00:00", parsed));
+    EXPECT_FALSE(commonlib::parseLocalTimestamp("2024-01-01 24:00:00", parsed));
+    EXPECT_FALSE(commonlib::parseLocalTimestamp("2024-01-01T00:00:00", parsed));
+    EXPECT_FALSE(commonlib::parseLocalTimestamp("2024-01-01 00:00", parsed));
+}
+
+/*
+* @ brief test parsing straight from a mapped file
+* @ detail Procedure: Write the output of all libraries to a file, map it and parse it
+*          Expected: All twelve events, with ids pointing into the mapping
+*/
+TEST(TestLogParser, mappedFile)
+{
+    const std::string path = ::testing::TempDir() + "logParser.txt";
+    const std::string text = writeAllLibraries();
+    std::ofstream(path, std::ios::binary) << text;
+
+    commonlib::MappedFile file(path);
+    ASSERT_EQ(file.text(), text);
+
+    std::size_t malformed = 0;
+    auto events = parseAll(file.text(), commonlib::LogParser::AUTO, malformed);
+    ASSERT_EQ(events.size(), 12u);
+    EXPECT_GE(events[0].id_.data(), file.text().data());
+    EXPECT_LT(events[0].id_.data(), file.text().data() + file.text().size());
+
+    EXPECT_THROW(commonlib::MappedFile(path + ".missing"), std::system_error);
+}
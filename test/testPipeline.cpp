@@ -0,0 +1,113 @@
+#include "alloctracklib/AllocTracker.hpp"
+#include "classiclib/Events.hpp"
+#include "commonlib/Pipeline.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace
+{
+
+const auto s_now = std::chrono::system_clock::now();
+
+std::vector<std::unique_ptr<classiclib::EventBase>> classicBatch()
+{
+    std::vector<std::unique_ptr<classiclib::EventBase>> events;
+    events.push_back(std::make_unique<classiclib::SessionStartEvent>(1, s_now, "session1", 10));
+    events.push_back(std::make_unique<classiclib::AuthLoginEvent>(2, s_now, "Fred", 20));
+    events.push_back(std::make_unique<classiclib::SessionEndEvent>(3, s_now + std::chrono::seconds(10), "session1", 30));
+    events.push_back(std::make_unique<classiclib::AuthLogoutEvent>(4, s_now, "Fred", 40));
+    events.push_back(std::make_unique<classiclib::SessionEndEvent>(5, s_now, "session2", 50));
+    return events;
+}
+
+} // end anonymous namespace
+
+/*
+* @ brief test that items pass through the stages in order and only past the filters they satisfy
+* @ detail Procedure: Filter on kind, pid and time, log every stage an item reaches, and dispatch the survivors
+*          Expected: Each item is taken through the whole chain before the next starts, rejected ones stop early
+*/
+TEST(TestPipeline, stagesInOrder)
+{
+    auto events = classicBatch();
+    std::string trace;
+
+    auto pipeline = commonlib::filter(commonlib::kindIn({ commonlib::EventKind::SESSION_START, commonlib::EventKind::SESSION_END }))
+                  | commonlib::enrich([&trace](auto & event) { trace += "e" + std::to_string(event->pid_); })
+                  | commonlib::filter(commonlib::pidIn(1, 3))
+                  | commonlib::filter(commonlib::timeIn(s_now, s_now + std::chrono::seconds(1)))
+                  | commonlib::dispatch([&trace](auto & event) { trace += "d" + std::to_string(event->pid_); });
+
+    EXPECT_EQ(pipeline.run(events), 1u);
+    EXPECT_EQ(trace, "e1d1e3e5");
+}
+
+/*
+* @ brief test that an enrichment returning a value replaces the item for the stages after it
+* @ detail Procedure: Enrich each event into its fingerprint and kind, filter and dispatch on those
+*          Expected: The later stages see the new type, and the events are untouched
+*/
+TEST(TestPipeline, typedEnrichment)
+{
+    auto events = classicBatch();
+
+    struct Annotated
+    {
+        const classiclib::EventBase * event_;
+        commonlib::EventKind kind_;
+        std::uint64_t fingerprint_;
+    };
+
+    std::vector<std::uint64_t> fingerprints;
+    auto pipeline = commonlib::enrich([](const auto & event) { return Annotated{ event.get(), classiclib::eventKind(event.get()), classiclib::fingerprint(event.get()) }; })
+                  | commonlib::filter([](const Annotated & annotated) { return annotated.kind_ == commonlib::EventKind::SESSION_END; })
+                  | commonlib::dispatch([&fingerprints](const Annotated & annotated) { fingerprints.push_back(annotated.fingerprint_); });
+
+    EXPECT_EQ(pipeline.run(events), 2u);
+    ASSERT_EQ(fingerprints.size(), 2u);
+    EXPECT_EQ(fingerprints[0], classiclib::fingerprint(events[2].get()));
+    EXPECT_EQ(fingerprints[1], classiclib::fingerprint(events[4].get()));
+}
+
+/*
+* @ brief test that the shared predicates work on every library's events and that a pass does not allocate
+* @ detail Procedure: Run a kind and pid filter over a batch from each library, formatting survivors into a reserved string
+*          Expected: The same events pass for every library and no allocation happens during the runs
+*/
+TEST(TestPipeline, allLibrariesWithoutAllocating)
+{
+    std::vector<std::unique_ptr<purecomplib::Event>> purecomp;
+    purecomp.push_back(std::make_unique<purecomplib::Event>(purecomplib::SessionEvent{ purecomplib::SessionStartEvent{ 1, s_now, "s", 1 } }));
+    purecomp.push_back(std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{ purecomplib::AuthLoginEvent{ 2, s_now, "u", 2 } }));
+    purecomp.push_back(std::make_unique<purecomplib::Event>(purecomplib::AuthEvent{ purecomplib::AuthLogoutEvent{ 9, s_now, "u", 3 } }));
+
+    std::vector<std::unique_ptr<templatecastlib::Event>> templatecast;
+    templatecast.push_back(std::make_unique<templatecastlib::SessionStartEvent>(1, s_now, "s", 1));
+    templatecast.push_back(std::make_unique<templatecastlib::AuthLoginEvent>(2, s_now, "u", 2));
+    templatecast.push_back(std::make_unique<templatecastlib::AuthLogoutEvent>(9, s_now, "u", 3));
+
+    std::string output;
+    output.reserve(4096);
+    auto pipeline = [&output]
+    {
+        return commonlib::filter(commonlib::kindIn({ commonlib::EventKind::AUTH_LOGIN, commonlib::EventKind::AUTH_LOGOUT }))
+             | commonlib::filter(commonlib::pidIn(0, 5))
+             | commonlib::dispatch([&output](const auto & event) { handleEvent(event.get(), output); });
+    };
+    auto purecompPipeline = pipeline();
+    auto templatecastPipeline = pipeline();
+
+    alloctracklib::AllocScope scope;
+    EXPECT_EQ(purecompPipeline.run(purecomp), 1u);
+    EXPECT_EQ(templatecastPipeline.run(templatecast), 1u);
+    EXPECT_EQ(scope.stats().allocations_, 0);
+
+    EXPECT_NE(output.find("Some specific data for AuthLoginEvent: 2\n"), std::string::npos);
+    EXPECT_NE(output.find("Specific data for auth login event: 2\n"), std::string::npos);
+}
@@ -0,0 +1,112 @@
+#include "classiclib/Events.hpp"
+#include "commonlib/PriorityDispatcher.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+#include <gtest/gtest.h>
+
+#include <vector>
+
+
+namespace
+{
+
+using Dispatcher = commonlib::PriorityDispatcher<int>;
+using commonlib::EventKind;
+
+const auto s_start = Dispatcher::Clock::time_point{} + std::chrono::hours(1);
+
+std::vector<int> dispatchAll(Dispatcher & dispatcher, std::size_t maxEvents, Dispatcher::Clock::time_point now)
+{
+    std::vector<int> order;
+    dispatcher.dispatch(maxEvents, [&order](EventKind, int & event, Dispatcher::Clock::time_point) { order.push_back(event); }, now);
+    return order;
+}
+
+} // end anonymous namespace
+
+/*
+* @ brief test that a more important kind is served before events that arrived earlier
+* @ detail Procedure: Queue logins then a session end given a higher priority, dispatch everything
+*          Expected: The session end comes first and the logins follow in arrival order
+*/
+TEST(TestPriorityDispatcher, servesByPriority)
+{
+    std::array<commonlib::KindPolicy, commonlib::EventKindCount> policies{};
+    policies[commonlib::kindIndex(EventKind::AUTH_LOGIN)].priority_ = 1;
+    Dispatcher dispatcher(policies, s_start);
+
+    dispatcher.submit(EventKind::AUTH_LOGIN, 1, s_start);
+    dispatcher.submit(EventKind::AUTH_LOGIN, 2, s_start);
+    dispatcher.submit(EventKind::SESSION_END, 3, s_start);
+
+    EXPECT_EQ(dispatchAll(dispatcher, 10, s_start), (std::vector<int>{ 3, 1, 2 }));
+    EXPECT_EQ(dispatcher.stats(EventKind::AUTH_LOGIN).dispatched_, 2u);
+}
+
+/*
+* @ brief test that a quota defers a kind until its tokens refill
+* @ detail Procedure: Allow 10 logins a second with a burst of 2, queue 3 and dispatch now and 100ms later
+*          Expected: 2 go out at once, the third is deferred and goes out after the refill
+*/
+TEST(TestPriorityDispatcher, quotaDefers)
+{
+    std::array<commonlib::KindPolicy, commonlib::EventKindCount> policies{};
+    policies[commonlib::kindIndex(EventKind::AUTH_LOGIN)].ratePerSecond_ = 10;
+    policies[commonlib::kindIndex(EventKind::AUTH_LOGIN)].burst_ = 2;
+    Dispatcher dispatcher(policies, s_start);
+
+    for(int i = 0; i < 3; ++i)
+    {
+        dispatcher.submit(EventKind::AUTH_LOGIN, i, s_start);
+    }
+
+    EXPECT_EQ(dispatchAll(dispatcher, 10, s_start).size(), 2u);
+    EXPECT_EQ(dispatcher.stats(EventKind::AUTH_LOGIN).deferred_, 1u);
+    EXPECT_EQ(dispatcher.queued(EventKind::AUTH_LOGIN), 1u);
+
+    EXPECT_EQ(dispatchAll(dispatcher, 10, s_start + std::chrono::milliseconds(100)), (std::vector<int>{ 2 }));
+}
+
+/*
+* @ brief test both shedding policies at the watermark
+* @ detail Procedure: Queue 3 events into kinds with a watermark of 2, one dropping the newest and one the oldest
+*          Expected: The first keeps events 0 and 1, the second 1 and 2, each counts one drop
+*/
+TEST(TestPriorityDispatcher, shedsAtWatermark)
+{
+    std::array<commonlib::KindPolicy, commonlib::EventKindCount> policies{};
+    policies[commonlib::kindIndex(EventKind::AUTH_LOGIN)].highWatermark_ = 2;
+    policies[commonlib::kindIndex(EventKind::AUTH_LOGOUT)].highWatermark_ = 2;
+    policies[commonlib::kindIndex(EventKind::AUTH_LOGOUT)].shed_ = commonlib::KindPolicy::DROP_OLDEST;
+    policies[commonlib::kindIndex(EventKind::AUTH_LOGOUT)].priority_ = 1;
+    Dispatcher dispatcher(policies, s_start);
+
+    EXPECT_TRUE(dispatcher.submit(EventKind::AUTH_LOGIN, 0, s_start));
+    EXPECT_TRUE(dispatcher.submit(EventKind::AUTH_LOGIN, 1, s_start));
+    EXPECT_FALSE(dispatcher.submit(EventKind::AUTH_LOGIN, 2, s_start));
+    for(int i = 10; i < 13; ++i)
+    {
+        EXPECT_TRUE(dispatcher.submit(EventKind::AUTH_LOGOUT, i, s_start));
+    }
+
+    EXPECT_EQ(dispatchAll(dispatcher, 10, s_start), (std::vector<int>{ 0, 1, 11, 12 }));
+    EXPECT_EQ(dispatcher.stats(EventKind::AUTH_LOGIN).dropped_, 1u);
+    EXPECT_EQ(dispatcher.stats(EventKind::AUTH_LOGOUT).dropped_, 1u);
+    EXPECT_EQ(dispatcher.stats(EventKind::AUTH_LOGOUT).submitted_, 3u);
+}
+
+/*
+* @ brief test that each library maps its events to the shared kinds
+* @ detail Procedure: Ask eventKind() of a session end event from each library
+*          Expected: SESSION_END every time
+*/
+TEST(TestPriorityDispatcher, libraryEventKinds)
+{
+    classiclib::SessionEndEvent classic{ 9876, std::chrono::system_clock::now(), "session123", 42 };
+    purecomplib::Event purecomp{ purecomplib::SessionEvent{ purecomplib::SessionEndEvent{ 9876, std::chrono::system_clock::now(), "session123", 42 } } };
+    templatecastlib::SessionEndEvent templatecast{ 9876, std::chrono::system_clock::now(), "session123", 42 };
+
+    EXPECT_EQ(classiclib::eventKind(&classic), EventKind::SESSION_END);
+    EXPECT_EQ(purecomplib::eventKind(&purecomp), EventKind::SESSION_END);
+    EXPECT_EQ(templatecastlib::eventKind(&templatecast), EventKind::SESSION_END);
+}
@@ -0,0 +1,115 @@
+#include "classiclib/Events.hpp"
+#include "commonlib/Hash.hpp"
+#include "commonlib/Sampler.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+#include <gtest/gtest.h>
+
+#include <string>
+
+
+namespace
+{
+
+using commonlib::EventKind;
+
+const auto s_start = std::chrono::steady_clock::time_point{} + std::chrono::hours(1);
+
+std::array<commonlib::SamplingPolicy, commonlib::EventKindCount> loginPolicy(const commonlib::SamplingPolicy & policy)
+{
+    std::array<commonlib::SamplingPolicy, commonlib::EventKindCount> policies{};
+    policies[commonlib::kindIndex(EventKind::AUTH_LOGIN)] = policy;
+    return policies;
+}
+
+} // end anonymous namespace
+
+/*
+* @ brief test that a fixed rate keeps about that fraction of keys, the same ones every time, with the matching weight
+* @ detail Procedure: Sample 100000 distinct keys twice at a rate of 0.25, and sample logouts which keep everything
+*          Expected: About a quarter are kept, both passes agree, the weight is 4 and every logout is kept with weight 1
+*/
+TEST(TestSampler, fixedRate)
+{
+    commonlib::SamplingPolicy policy;
+    policy.mode_ = commonlib::SamplingPolicy::FIXED;
+    policy.rate_ = 0.25;
+    commonlib::Sampler sampler(loginPolicy(policy), s_start);
+
+    std::size_t kept = 0;
+    for(std::uint64_t i = 0; i < 100000; ++i)
+    {
+        auto first = sampler.sample(EventKind::AUTH_LOGIN, commonlib::mixHash(i));
+        auto second = sampler.sample(EventKind::AUTH_LOGIN, commonlib::mixHash(i));
+        EXPECT_EQ(first.keep_, second.keep_);
+        if(first.keep_)
+        {
+            EXPECT_DOUBLE_EQ(first.weight_, 4.0);
+            ++kept;
+        }
+
+        auto logout = sampler.sample(EventKind::AUTH_LOGOUT, commonlib::mixHash(i));
+        EXPECT_TRUE(logout.keep_);
+        EXPECT_DOUBLE_EQ(logout.weight_, 1.0);
+    }
+    EXPECT_NEAR(static_cast<double>(kept) / 100000, 0.25, 0.01);
+}
+
+/*
+* @ brief test that an adaptive rate converges on its target and only ever drops keys when lowered
+* @ detail Procedure: Offer 100000 logins per simulated second against a target of 1000, updating every 100ms
+*          Expected: The rate settles near 1%, and a key kept at the final rate was kept at every rate before it
+*/
+TEST(TestSampler, adaptiveRate)
+{
+    commonlib::SamplingPolicy policy;
+    policy.mode_ = commonlib::SamplingPolicy::ADAPTIVE;
+    policy.targetPerSecond_ = 1000;
+    commonlib::Sampler sampler(loginPolicy(policy), s_start);
+
+    EXPECT_DOUBLE_EQ(sampler.rate(EventKind::AUTH_LOGIN), 1.0);
+    auto now = s_start;
+    for(int interval = 0; interval < 20; ++interval)
+    {
+        for(std::uint64_t i = 0; i < 10000; ++i)
+        {
+            sampler.sample(EventKind::AUTH_LOGIN, commonlib::mixHash(i));
+        }
+        now += std::chrono::milliseconds(100);
+        sampler.update(now);
+    }
+    EXPECT_NEAR(sampler.rate(EventKind::AUTH_LOGIN), 0.01, 0.001);
+
+    commonlib::SamplingPolicy fixed;
+    fixed.mode_ = commonlib::SamplingPolicy::FIXED;
+    fixed.rate_ = 0.5;
+    commonlib::Sampler half(loginPolicy(fixed), s_start);
+    for(std::uint64_t i = 0; i < 10000; ++i)
+    {
+        if(sampler.sample(EventKind::AUTH_LOGIN, commonlib::mixHash(i)).keep_)
+        {
+            EXPECT_TRUE(half.sample(EventKind::AUTH_LOGIN, commonlib::mixHash(i)).keep_);
+        }
+    }
+}
+
+/*
+* @ brief test that every library derives the same key from the same id and that the weight is written after the record
+* @ detail Procedure: Build a login for the same user in each library, then append a weight of 8 and of 1 to a string
+*          Expected: The three keys are equal and only the weight of 8 is written
+*/
+TEST(TestSampler, keysAndWeights)
+{
+    classiclib::AuthLoginEvent classic{ 6789, std::chrono::system_clock::now(), "Fred", 42 };
+    purecomplib::Event purecomp{ purecomplib::AuthEvent{ purecomplib::AuthLoginEvent{ 6789, std::chrono::system_clock::now(), "Fred", 42 } } };
+    templatecastlib::AuthLoginEvent templatecast{ 6789, std::chrono::system_clock::now(), "Fred", 42 };
+
+    EXPECT_EQ(classiclib::samplingKey(&classic), commonlib::hashBytes("Fred"));
+    EXPECT_EQ(purecomplib::samplingKey(&purecomp), commonlib::hashBytes("Fred"));
+    EXPECT_EQ(templatecastlib::samplingKey(&templatecast), commonlib::hashBytes("Fred"));
+
+    std::string sink;
+    commonlib::appendSampleWeight(sink, 8.0);
+    commonlib::appendSampleWeight(sink, 1.0);
+    EXPECT_EQ(sink, "Sample weight is 8\n");
+}
@@ -0,0 +1,73 @@
+#include "alloctracklib/AllocTracker.hpp"
+#include "classiclib/Events.hpp"
+#include "purecomplib/Events.hpp"
+#include "templatecastlib/Events.hpp"
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+
+
+namespace
+{
+
+const auto s_timestamp = std::chrono::system_clock::now();
+const std::string s_timestampText(commonlib::formatLocalTimestamp(s_timestamp));
+
+} // end anonymous namespace
+
+/*
+* @ brief test that the std::ostream overload writes what the sink template writes
+* @ detail Procedure: Handle the same event of each library into a std::ostringstream and into a std::string
+*          Expected: Both hold the same text
+*/
+TEST(TestSinks, ostreamWrapperMatchesSink)
+{
+    classiclib::AuthLoginEvent classicEvent{ 6789, s_timestamp, "Fred", 42 };
+    purecomplib::Event pureCompEvent{ purecomplib::SessionEvent{ purecomplib::SessionEndEvent{ 9876, s_timestamp, "session123", 7 } } };
+    templatecastlib::SessionStartEvent templateCastEvent{ 9876, s_timestamp, "session123", 42 };
+
+    std::ostringstream stream;
+    std::string text;
+
+    classiclib::handleEvent(&classicEvent, stream);
+    classiclib::handleEvent(&classicEvent, text);
+    purecomplib::handleEvent(&pureCompEvent, stream);
+    purecomplib::handleEvent(&pureCompEvent, text);
+    templatecastlib::handleEvent(&templateCastEvent, stream);
+    templatecastlib::handleEvent(&templateCastEvent, text);
+
+    std::string expected;
+    expected += "PID is 6789\nTimestamp is " + s_timestampText + "\nUser is Fred\nSome specific data for auth login: 42\n";
+    expected += "PID is 9876\nTimestamp is " + s_timestampText + "\nSession id is session123\nSome specific data for SessionEndEvent: 7\n";
+    expected += "PID is 9876\nTimestamp is " + s_timestampText + "\nSession id is session123\nSpecific data for session start event: 42\n";
+
+    EXPECT_EQ(expected, text);
+    EXPECT_EQ(stream.str(), text);
+}
+
+/*
+* @ brief test that the specialized sinks are zero allocation
+* @ detail Procedure: Handle one event of each library into a CountingSink and a reserved BufferSink
+*          Expected: Neither allocates, and both see the same number of bytes
+*/
+TEST(TestSinks, specializedSinksDoNotAllocate)
+{
+    classiclib::SessionStartEvent classicEvent{ 9876, s_timestamp, "session123", 42 };
+    purecomplib::Event pureCompEvent{ purecomplib::AuthEvent{ purecomplib::AuthLogoutEvent{ 6789, s_timestamp, "Fred", 42 } } };
+    templatecastlib::AuthLoginEvent templateCastEvent{ 6789, s_timestamp, "Fred", 42 };
+
+    commonlib::CountingSink counting;
+    commonlib::BufferSink buffer(4096);
+
+    alloctracklib::AllocScope scope;
+    classiclib::handleEvent(&classicEvent, counting);
+    classiclib::handleEvent(&classicEvent, buffer);
+    purecomplib::handleEvent(&pureCompEvent, counting);
+    purecomplib::handleEvent(&pureCompEvent, buffer);
+    templatecastlib::handleEvent(&templateCastEvent, counting);
+    templatecastlib::handleEvent(&templateCastEvent, buffer);
+
+    EXPECT_EQ(0u, scope.stats().allocations_);
+    EXPECT_EQ(counting.bytes(), buffer.size());
+}